@@ -0,0 +1,273 @@
+/*
+ *
+ * GraphBench
+ * Headless sampling throughput benchmark
+ *
+ * Samples a fixed corpus of expressions with every Sampler engine and an
+ * increasing number of threads, without any window or GL context, and prints
+ * the results as JSON on the standard output so runs of different releases
+ * can be compared. Progress goes to the standard error.
+ *
+ * GraphBench [--samples N] [--repeat N] [--max-threads N] [--out FILE]
+ *
+ */
+
+#include "../src/include/sampler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ *
+ * Corpus
+ *
+ */
+
+struct Expression
+{
+    const char* category;
+    const char* expression;
+    double start, end; // domain
+};
+
+static const Expression corpus[] =
+{
+    {"polynomial", "x^2",                                      -10.0, 10.0},
+    {"polynomial", "3*x^5 - 2*x^3 + x - 7",                    -10.0, 10.0},
+    {"polynomial", "(x - 1)*(x + 2)*(x - 3)*(x + 4)*(x - 5)",  -10.0, 10.0},
+    {"trig",       "sin(x)",                                   -10.0, 10.0},
+    {"trig",       "sin(x)*cos(2*x) + tan(x/3)",               -10.0, 10.0},
+    {"trig",       "sin(x)^2 + cos(x)^2 + atan(x)",            -10.0, 10.0},
+    {"nested",     "exp(sin(cos(x)))",                         -10.0, 10.0},
+    {"nested",     "sqrt(1 + ln(1 + x^2)) * sinh(x/10)",       -10.0, 10.0},
+    {"nested",     "sin(sin(sin(sin(x))))",                    -10.0, 10.0},
+    {"piecewise",  "x < 0 ? -x : x^2",                         -10.0, 10.0},
+    {"piecewise",  "abs(x) < 1 ? 1 - abs(x) : sin(x)/x",       -10.0, 10.0},
+    {"piecewise",  "x < -5 ? 0 : (x < 5 ? x^3 : 125)",         -10.0, 10.0},
+};
+
+static const Sampler::Engine engines[] = {Sampler::Interpreter, Sampler::Jit, Sampler::Simd};
+
+struct Options
+{
+    int samples = 1 << 20;
+    int repeat = 5;
+    int maxThreads = 0; // 0 - one per hardware thread
+    std::string out;    // empty - standard output
+};
+
+struct Result
+{
+    const Expression* expression;
+    Sampler::Engine engine;
+    Sampler::Engine activeEngine;
+    int threads;
+    double seconds; // median of the runs
+    double speedup; // over one thread with the same engine
+    std::string error;
+};
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+static std::string json_string (const std::string& str)
+{
+    std::string out = "\"";
+    for(char c : str)
+    {
+        if(c == '"' || c == '\\')
+            out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+static std::string json_number (double value)
+{
+    std::ostringstream stream;
+    stream.precision(6);
+    stream << value;
+    return stream.str();
+}
+
+// 1, 2, 4, ... and maxThreads itself
+static std::vector<int> thread_counts (int maxThreads)
+{
+    std::vector<int> counts;
+    for(int t = 1; t < maxThreads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+static bool parse_options (int argc, char** argv, Options& options)
+{
+    for(int i = 1; i < argc; i++)
+    {
+        const bool value = i + 1 < argc;
+        if(value && std::strcmp(argv[i], "--samples") == 0)
+            options.samples = std::atoi(argv[++i]);
+        else if(value && std::strcmp(argv[i], "--repeat") == 0)
+            options.repeat = std::atoi(argv[++i]);
+        else if(value && std::strcmp(argv[i], "--max-threads") == 0)
+            options.maxThreads = std::atoi(argv[++i]);
+        else if(value && std::strcmp(argv[i], "--out") == 0)
+            options.out = argv[++i];
+        else
+            return false;
+    }
+    return options.samples > 1 && options.repeat > 0 && options.maxThreads >= 0;
+}
+
+/*
+ *
+ * Benchmark
+ *
+ */
+
+// Median wall time of one sample() of the whole domain
+static double time_sampling (Sampler& sampler, const Expression& expression, int samples, int repeat, std::vector<float>& vertices)
+{
+    const double step = (expression.end - expression.start) / (samples - 1);
+    auto run = [&]()
+    {
+        sampler.sample(vertices.data(), samples, samples, expression.start, step, 0.0, 0.0, 1.0f, 1.0f);
+    };
+
+    run(); // warm-up, also touches the vertex buffer
+
+    std::vector<double> times;
+    for(int r = 0; r < repeat; r++)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        run();
+        const auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double>(end - begin).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static void write_json (std::ostream& out, const Options& options, int maxThreads, const std::vector<Result>& results)
+{
+#ifdef GRAPH_DEBUG
+    const char* build = "debug";
+#else
+    const char* build = "release";
+#endif
+
+    out << "{\n";
+    out << "  \"benchmark\": \"GraphBench\",\n";
+    out << "  \"build\": " << json_string(build) << ",\n";
+    out << "  \"samples\": " << options.samples << ",\n";
+    out << "  \"repeat\": " << options.repeat << ",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "  \"max_threads\": " << maxThreads << ",\n";
+    out << "  \"simd_isa\": " << json_string(SimdEvaluator::getIsaName(SimdEvaluator::detectIsa())) << ",\n";
+    out << "  \"results\": [\n";
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const Result& result = results[i];
+        out << "    {";
+        out << "\"category\": " << json_string(result.expression->category) << ", ";
+        out << "\"expression\": " << json_string(result.expression->expression) << ", ";
+        out << "\"domain\": [" << json_number(result.expression->start) << ", " << json_number(result.expression->end) << "], ";
+        out << "\"engine\": " << json_string(Sampler::getEngineName(result.engine)) << ", ";
+        out << "\"threads\": " << result.threads << ", ";
+
+        if(!result.error.empty())
+        {
+            out << "\"error\": " << json_string(result.error);
+        }
+        else
+        {
+            out << "\"active_engine\": " << json_string(Sampler::getEngineName(result.activeEngine)) << ", ";
+            out << "\"ns_per_sample\": " << json_number(result.seconds * 1e9 / options.samples) << ", ";
+            out << "\"samples_per_sec\": " << json_number(options.samples / result.seconds) << ", ";
+            out << "\"speedup\": " << json_number(result.speedup);
+        }
+        out << ((i + 1 < results.size()) ? "},\n" : "}\n");
+    }
+
+    out << "  ]\n";
+    out << "}\n";
+}
+
+int main (int argc, char** argv)
+{
+    Options options;
+    if(!parse_options(argc, argv, options))
+    {
+        std::cerr << "usage: GraphBench [--samples N] [--repeat N] [--max-threads N] [--out FILE]" << std::endl;
+        return 1;
+    }
+
+    const int maxThreads = (options.maxThreads > 0) ? options.maxThreads
+                                                    : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::vector<float> vertices(static_cast<size_t>(options.samples) * 2); /* x,y attributes */
+    std::vector<Result> results;
+
+    for(int threads : thread_counts(maxThreads))
+    {
+        Sampler sampler(threads);
+        sampler.setSimdIsa(SimdEvaluator::detectIsa());
+
+        for(const Expression& expression : corpus)
+        {
+            for(Sampler::Engine engine : engines)
+            {
+                std::cerr << threads << " threads, " << Sampler::getEngineName(engine) << ": " << expression.expression << std::endl;
+
+                Result result = {&expression, engine, engine, threads, 0.0, 1.0, ""};
+                try
+                {
+                    sampler.setFunction(expression.expression);
+                    sampler.setEngine(engine);
+                    result.activeEngine = sampler.getActiveEngine();
+                    result.seconds = time_sampling(sampler, expression, options.samples, options.repeat, vertices);
+                }
+                catch (mu::Parser::exception_type& e)
+                {
+                    result.error = e.GetMsg();
+                }
+
+                // compared with the single thread run of the same expression and engine
+                for(const Result& single : results)
+                {
+                    if(single.threads == 1 && single.expression == &expression && single.engine == engine && single.error.empty())
+                        result.speedup = single.seconds / result.seconds;
+                }
+                results.push_back(result);
+            }
+        }
+    }
+
+    if(options.out.empty())
+    {
+        write_json(std::cout, options, maxThreads, results);
+        return 0;
+    }
+
+    std::ofstream file(options.out);
+    if(!file)
+    {
+        std::cerr << "ERROR: cannot write " << options.out << std::endl;
+        return 1;
+    }
+    write_json(file, options, maxThreads, results);
+    return 0;
+}
@@ -1,3 +1,8 @@
+newoption {
+    trigger     = "openmp",
+    description = "Spread bulk function evaluation across cores (muparser must be built with MUP_USE_OPENMP as well)"
+}
+
 workspace "Graph"
     configurations { "Debug", "Release" }
 
@@ -21,6 +26,7 @@ project "GraphApp"
 
     includedirs { "include" }
     files { "**.h*", "**.c*" }
+    removefiles { "bench/**" }
     
 	libdirs { "." }
     links { "freetype", "muparser" }
@@ -30,3 +36,44 @@ project "GraphApp"
 
 	filter "system:linux"
 		links { "dl", "glfw" }
+
+    filter "options:openmp"
+        defines { "MUP_USE_OPENMP" }
+        openmp "On"
+
+    -- only called after cpuid reports AVX2, see SimdEvaluator
+    filter "files:src/expression/simd_avx2.cpp"
+        vectorextensions "AVX2"
+
+-- Sampling throughput without a window or GL context, see bench/graphbench.cpp
+project "GraphBench"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+    warnings "off"
+
+    targetdir ("bin/" .. outputdir)
+    objdir ("bin-int/" .. outputdir)
+
+    includedirs { "include" }
+    files
+    {
+        "bench/**.cpp",
+        "src/sampler.cpp",
+        "src/include/sampler.hpp",
+        "src/expression/**.cpp",
+        "src/include/expression/**.hpp"
+    }
+
+    libdirs { "." }
+    links { "muparser" }
+
+    filter "system:linux"
+        links { "pthread" }
+
+    filter "options:openmp"
+        defines { "MUP_USE_OPENMP" }
+        openmp "On"
+
+    filter "files:src/expression/simd_avx2.cpp"
+        vectorextensions "AVX2"
@@ -1,7 +1,7 @@
 #version 450 core
 out vec4 FragColor;
 
-uniform vec3 color;
+flat in vec3 color;
 
 void main()
 {
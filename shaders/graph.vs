@@ -3,10 +3,30 @@ layout (location = 0) in vec2 aPos;
 
 layout(std140, binding = 0) uniform Camera
 {
-    mat4 projection;
+    mat4 projection; // around the view center
+    vec2 residual;   // view center - floating origin
 };
 
+// Graph::MAX_CURVES
+#define MAX_CURVES 64
+
+// Curves drawn by the same call, curve i starts at vertex curveFirst[i]
+uniform int  curveCount;
+uniform int  curveFirst[MAX_CURVES];
+uniform vec3 curveColor[MAX_CURVES];
+
+// Floating origin the vertices were written against - the camera's one,
+// non-zero only until vertices written before a re-base are replaced
+uniform vec2 shift;
+
+flat out vec3 color;
+
 void main()
 {
-    gl_Position = projection * vec4(aPos, 0.0, 1.0);
+    int curve = 0;
+    while(curve + 1 < curveCount && gl_VertexID >= curveFirst[curve + 1])
+        curve++;
+    color = curveColor[curve];
+
+    gl_Position = projection * vec4(aPos + shift - residual, 0.0, 1.0);
 }
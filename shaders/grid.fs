@@ -0,0 +1,30 @@
+#version 450 core
+in vec2 coord;
+out vec4 FragColor;
+
+uniform vec3 color;
+uniform vec2 spacing; // of the finest lines, the next tiers are 10 and 100 times as far apart
+uniform vec2 fade;    // 0 where the finest lines are about to become too dense, 1 where they just appeared
+
+const float MAJOR_ALPHA = 0.35;
+const float MINOR_ALPHA = 0.15;
+
+// Coverage of the vertical and the horizontal lines every "step", a pixel wide and antialiased
+vec2 lines (vec2 step)
+{
+    vec2 c = coord / step;
+    vec2 pixels = abs(fract(c - 0.5) - 0.5) / fwidth(c); // to the nearest line
+    return 1.0 - min(pixels, 1.0);
+}
+
+void main()
+{
+    // Each tier fades towards the alpha of the tier below it, which it becomes at the next power of ten,
+    // so that a line keeps its alpha while the zoom goes through it
+    vec2 minor  = lines(spacing)          * fade * MINOR_ALPHA;
+    vec2 middle = lines(spacing * 10.0)   * mix(vec2(MINOR_ALPHA), vec2(MAJOR_ALPHA), fade);
+    vec2 major  = lines(spacing * 100.0)  * MAJOR_ALPHA;
+
+    vec2 alpha = max(max(minor, middle), major);
+    FragColor = vec4(color, max(alpha.x, alpha.y));
+}
@@ -0,0 +1,21 @@
+#version 450 core
+out vec2 coord; // graph coordinates
+
+layout(std140, binding = 0) uniform Camera
+{
+    mat4 projection; // around the view center
+    vec2 residual;   // view center - floating origin
+};
+
+uniform vec2 ratio;  // world units per graph unit
+uniform vec2 center; // graph coordinates of the view center, modulo 100 times the spacing
+
+void main()
+{
+    // one triangle covering the screen, (-1, -1) (3, -1) (-1, 3)
+    vec2 ndc = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(ndc, 0.0, 1.0);
+
+    vec2 offset = (inverse(projection) * gl_Position).xy; // world units from the view center
+    coord = center + offset / ratio;
+}
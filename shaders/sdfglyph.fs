@@ -0,0 +1,17 @@
+#version 450 core
+in vec2 TexCoords;
+out vec4 color2;
+
+uniform sampler2D text;
+uniform vec4 textColor;
+
+void main()
+{
+    // signed distance to the outline, 0.5 on it and larger inside
+    float distance = texture(text, TexCoords).r;
+
+    // antialiased over about a screen pixel whatever the scale of the glyph
+    float width = fwidth(distance);
+    float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+    color2 = vec4(textColor.rgb, textColor.a * alpha);
+}
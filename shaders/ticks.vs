@@ -0,0 +1,18 @@
+#version 450 core
+layout (location = 1) in vec4 aTick; // offset.xy, scale.xy of the tick, relative to the graph position
+
+layout(std140, binding = 0) uniform Camera
+{
+    mat4 projection; // around the view center
+    vec2 residual;   // view center - floating origin
+};
+
+uniform vec2 translation; // graph position - floating origin
+
+void main()
+{
+    // the two vertices of the segment from offset to offset + scale
+    vec2 base = vec2(gl_VertexID);
+    vec2 world = translation + aTick.xy + base * aTick.zw;
+    gl_Position = projection * vec4(world - residual, 0.0, 1.0);
+}
@@ -3,12 +3,14 @@ layout (location = 0) in vec2 aPos;
 
 layout(std140, binding = 0) uniform Camera
 {
-    mat4 projection;
+    mat4 projection; // around the view center
+    vec2 residual;   // view center - floating origin
 };
 
-uniform mat4 model;
+uniform mat4 model; // relative to the floating origin
 
 void main()
 {
-    gl_Position = projection * model * vec4(aPos, 0.0, 1.0);
+    vec4 world = model * vec4(aPos, 0.0, 1.0);
+    gl_Position = projection * vec4(world.xy - residual, 0.0, 1.0);
 }
@@ -0,0 +1,282 @@
+#include "include/adaptivesampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+// Vertical distance in pixels between the midpoint m and the chord a-b.
+// Unlike the perpendicular distance it does not vanish on the near-vertical
+// chords across poles and jumps, so those keep being split down to MIN_WIDTH
+static double chord_deviation (double ay, double my, double by)
+{
+    return std::fabs(my - 0.5 * (ay + by));
+}
+
+// Could the enclosure hide a spike the samples a, m, b did not catch
+static bool hides_spike (const Interval& bounds, double ay, double my, double by, double tol)
+{
+    const double lo = std::min({ay, my, by});
+    const double hi = std::max({ay, my, by});
+    return bounds.hi - bounds.lo > AdaptiveSampler::SPIKE_RATIO * (hi - lo) + tol;
+}
+
+// Bound of the vertical distance between the chord a-b and the cubic Hermite interpolant
+// of the slopes sa, sb: h t (1 - t) ((sa - c)(1 - t) - (sb - c) t) peaks below 4/27 h max|s - c|.
+// Unknown slopes bound nothing
+static double hermite_deviation (double ax, double ay, double sa, double bx, double by, double sb)
+{
+    const double h = bx - ax;
+    const double c = (by - ay) / h;
+    const double d = std::fmax(std::fabs(sa - c), std::fabs(sb - c));
+    return std::isnan(d) ? 0.0 : 4.0 / 27.0 * h * d;
+}
+
+/*
+ *
+ * AdaptiveSampler
+ *
+ */
+
+void AdaptiveSampler::sample
+(
+    Sampler& sampler,
+    double start, double end,
+    double bottom, double top,
+    double originX, double originY,
+    float ratioX, float ratioY,
+    float zoom
+)
+{
+    const double scaleX = std::fabs(ratioX * zoom); // function units to pixels
+    const double scaleY = std::fabs(ratioY * zoom);
+
+    const double pixels = (end - start) * scaleX;
+    const int intervals = std::max(16, std::min(MAX_POINTS / 4, static_cast<int>(pixels / INITIAL_WIDTH)));
+
+    vertices.clear();
+    stripFirst.clear();
+    stripCount.clear();
+    curveFirst.clear();
+    passes = 0;
+    culled = 0;
+    tangentSplits = 0;
+    tangents = false;
+
+    for(int function = 0; function < sampler.getFunctionCount(); function++)
+    {
+        X.resize(intervals + 1);
+        Y.resize(intervals + 1);
+        for(int i = 0; i <= intervals; i++)
+            X[i] = start + (end - start) * i / intervals;
+        sampler.evaluate(X.data(), Y.data(), intervals + 1, function);
+
+        S.resize(intervals + 1);
+        const bool slopes = sampler.evaluateSlope(X.data(), S.data(), intervals + 1, function);
+        tangents = tangents || slopes;
+        if(!slopes)
+            S.clear();
+
+        state.assign(intervals, Split);
+
+        curveFirst.push_back(static_cast<int>(vertices.size() / 2));
+        refine(sampler, function, scaleX, scaleY, bottom, top);
+        emit(originX, originY, ratioX, ratioY);
+    }
+}
+
+// Subdivides the intervals marked Split until all of them are Done or Break
+void AdaptiveSampler::refine (Sampler& sampler, int function, double scaleX, double scaleY, double bottom, double top)
+{
+    const double tol = tolerance;
+    const double tolY = tol / scaleY; // in function units
+
+    Interval bounds = Interval::entire();
+    bool enclosed = false;
+
+    for(int pass = 0; ; pass++)
+    {
+        passes = std::max(passes, pass);
+
+        midX.clear();
+        midBounds.clear();
+        for(size_t i = 0; i < state.size(); i++)
+        {
+            if(state[i] != Split)
+                continue;
+
+            enclosed = sampler.enclose(X[i], X[i + 1], bounds, function);
+            if(enclosed)
+            {
+                const bool outside = bounds.isEmpty() || bounds.hi < bottom || bounds.lo > top;
+                const bool flat = std::isfinite(Y[i]) && std::isfinite(Y[i + 1]) && bounds.hi - bounds.lo < tolY;
+                if(outside || flat)
+                {
+                    state[i] = Done;
+                    culled++;
+                    continue;
+                }
+            }
+
+            midX.push_back(0.5 * (X[i] + X[i + 1]));
+            midBounds.push_back(bounds);
+        }
+
+        if(midX.empty())
+            break;
+
+        midY.resize(midX.size());
+        sampler.evaluate(midX.data(), midY.data(), static_cast<int>(midX.size()), function);
+
+        const bool slopes = !S.empty();
+        if(slopes)
+        {
+            midS.resize(midX.size());
+            sampler.evaluateSlope(midX.data(), midS.data(), static_cast<int>(midX.size()), function);
+        }
+
+        const bool full = X.size() + midX.size() > static_cast<size_t>(MAX_POINTS);
+
+        nextX.clear();
+        nextY.clear();
+        nextS.clear();
+        nextState.clear();
+
+        size_t mid = 0;
+        for(size_t i = 0; i < state.size(); i++)
+        {
+            nextX.push_back(X[i]);
+            nextY.push_back(Y[i]);
+            if(slopes)
+                nextS.push_back(S[i]);
+
+            if(state[i] != Split)
+            {
+                nextState.push_back(state[i]);
+                continue;
+            }
+
+            const double ax = X[i],       ay = Y[i];
+            const double bx = X[i + 1],   by = Y[i + 1];
+            const double mx = midX[mid],  my = midY[mid];
+            const Interval& enclosure = midBounds[mid];
+            mid++;
+
+            nextX.push_back(mx);
+            nextY.push_back(my);
+            if(slopes)
+                nextS.push_back(midS[mid - 1]);
+
+            const bool finiteA = std::isfinite(ay);
+            const bool finiteM = std::isfinite(my);
+            const bool finiteB = std::isfinite(by);
+
+            // the halves can still be split if they are wide enough and representable
+            const bool splittable = !full && (mx - ax) * scaleX >= MIN_WIDTH && mx > ax && mx < bx;
+
+            State left, right;
+            if(!finiteA && !finiteM && !finiteB)
+            {
+                left = right = Done; // outside of the domain
+            }
+            else if(!finiteA || !finiteM || !finiteB)
+            {
+                // locate the edge of the domain, the non-finite sample splits the strip anyway
+                left = right = splittable ? Split : Done;
+            }
+            else if(chord_deviation(ay, my, by) * scaleY < tol && !(enclosed && hides_spike(enclosure, ay, my, by, tolY)))
+            {
+                left = right = Done;
+
+                // the halves have to follow their tangents too
+                if(slopes && splittable)
+                {
+                    const double sa = S[i], sm = midS[mid - 1], sb = S[i + 1];
+                    if(hermite_deviation(ax, ay, sa, mx, my, sm) * scaleY >= tol)
+                    {
+                        left = Split;
+                        tangentSplits++;
+                    }
+                    if(hermite_deviation(mx, my, sm, bx, by, sb) * scaleY >= tol)
+                    {
+                        right = Split;
+                        tangentSplits++;
+                    }
+                }
+            }
+            else if(splittable)
+            {
+                left = right = Split;
+            }
+            else
+            {
+                // Still off the chord at the finest width. Halving a continuous piece about
+                // halves its rise, a jump stays in one half and a pole overshoots both ends
+                const double jumpL = std::fabs(my - ay) * scaleY;
+                const double jumpR = std::fabs(by - my) * scaleY;
+                const double steep = std::max(jumpL, jumpR);
+
+                const bool monotone = (my - ay) * (by - my) >= 0.0;
+                const bool jump = steep > tol && (!monotone || steep > JUMP_SHARE * std::fabs(by - ay) * scaleY);
+
+                left  = (jump && jumpL >= jumpR) ? Break : Done;
+                right = (jump && jumpR >  jumpL) ? Break : Done;
+            }
+
+            nextState.push_back(left);
+            nextState.push_back(right);
+        }
+        nextX.push_back(X.back());
+        nextY.push_back(Y.back());
+        if(slopes)
+            nextS.push_back(S.back());
+
+        X.swap(nextX);
+        Y.swap(nextY);
+        S.swap(nextS);
+        state.swap(nextState);
+    }
+}
+
+// Converts the samples into vertices appended to the previous curves, one line strip per continuous piece
+void AdaptiveSampler::emit (double originX, double originY, float ratioX, float ratioY)
+{
+    int first = static_cast<int>(vertices.size() / 2);
+    auto close_strip = [&]()
+    {
+        const int count = static_cast<int>(vertices.size() / 2) - first;
+        if(count >= 2)
+        {
+            stripFirst.push_back(first);
+            stripCount.push_back(count);
+        }
+        else
+        {
+            vertices.resize(first * 2); // a single vertex draws nothing
+        }
+        first = static_cast<int>(vertices.size() / 2);
+    };
+
+    for(size_t i = 0; i < X.size(); i++)
+    {
+        const float vx = static_cast<float>(originX + X[i] * ratioX);
+        const float vy = static_cast<float>(originY + Y[i] * ratioY);
+
+        if(std::isfinite(vy))
+        {
+            vertices.push_back(vx);
+            vertices.push_back(vy);
+        }
+        else
+        {
+            close_strip();
+        }
+
+        if(i < state.size() && state[i] == Break)
+            close_strip();
+    }
+    close_strip();
+}
@@ -0,0 +1,156 @@
+#include "include/asyncsampler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+/*
+ *
+ * AsyncSampler
+ *
+ */
+
+AsyncSampler::AsyncSampler ()
+{
+    thread = std::thread(&AsyncSampler::workerLoop, this);
+}
+
+AsyncSampler::~AsyncSampler ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    generation++; // abandons the job in flight
+    wake.notify_one();
+    thread.join();
+}
+
+void AsyncSampler::submit (const Request& _request)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        request = _request;
+        requested = true;
+        queued = true;
+        generation++;
+    }
+    wake.notify_one();
+}
+
+void AsyncSampler::cancel ()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    requested = false;
+    queued = false;
+    generation++;
+}
+
+bool AsyncSampler::poll (Result& result)
+{
+    while(results.pop(result))
+    {
+        if(result.generation == generation.load())
+            return true;
+
+        recycle(result); // superseded while it was queued
+    }
+    return false;
+}
+
+void AsyncSampler::recycle (Result& result)
+{
+    buffers.push(result.vertices); // dropped if the worker already has enough spare buffers
+}
+
+void AsyncSampler::workerLoop ()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for(;;)
+    {
+        wake.wait(lock, [this]{ return quit || requested; });
+        if(quit)
+            return;
+
+        const Request current = request;
+        const unsigned int current_generation = generation.load();
+        requested = false;
+        running = true;
+        queued = false;
+        lock.unlock();
+
+        run(current, current_generation);
+
+        lock.lock();
+        running = false;
+    }
+}
+
+void AsyncSampler::run (const Request& _request, unsigned int _generation)
+{
+    Result result;
+    result.generation = _generation;
+    result.count = _request.count;
+    result.curves = static_cast<int>(_request.functions.size());
+    result.originX = _request.originX;
+    result.originY = _request.originY;
+
+    total = _request.count;
+    progress = 0;
+
+    // nothing may escape the worker thread, every error goes back with the result
+    try
+    {
+        if(!buffers.pop(result.vertices))
+            result.vertices.clear();
+        result.vertices.resize(static_cast<size_t>(_request.count) * result.curves * 2); /* x,y attributes */
+
+        if(_request.functions != sampler.getFunctions())
+            sampler.setFunctions(_request.functions);
+        if(_request.engine != sampler.getEngine())
+            sampler.setEngine(_request.engine);
+        sampler.setSimdIsa(_request.isa);
+        sampler.setDerivative(_request.derivative);
+
+        for(int first = 0; first < _request.count; first += CHUNK_SIZE)
+        {
+            if(generation.load() != _generation)
+                return; // superseded
+
+            const int count = std::min(CHUNK_SIZE, _request.count - first);
+            sampler.sample
+            (
+                result.vertices.data() + first * 2, count, _request.count,
+                _request.start + first * _request.step, _request.step,
+                _request.originX, _request.originY,
+                _request.ratioX, _request.ratioY
+            );
+            progress = first + count;
+        }
+    }
+    catch (mu::Parser::exception_type& e)
+    {
+        result.error = e.GetMsg();
+    }
+    catch (const std::exception& e) // out of memory, the JIT or the SIMD setup
+    {
+        result.error = e.what();
+    }
+    catch (...)
+    {
+        result.error = "unknown error";
+    }
+
+    if(!result.error.empty())
+    {
+        result.count = 0;
+        result.curves = 0;
+    }
+
+    // the render thread drains the queue every frame
+    while(!results.push(result))
+    {
+        if(generation.load() != _generation)
+            return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
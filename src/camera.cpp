@@ -2,6 +2,7 @@
 #include <GL/gl.h>
 #include "include/camera.hpp"
 #include "include/debug/ClassManager.hpp"
+#include <cmath>
 #include <string>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -12,13 +13,26 @@
  *
  */
 
-// Update the projection matrix
+// Update the projection matrix, re-basing the floating origin if the view drifted too far from it
 void Camera::updateProjectionMatrix (GLuint screenW, GLuint screenH)
 {
-    glm::vec2 left_top     = ScreenToWorld(0, 0)             + position;
-    glm::vec2 right_bottom = ScreenToWorld(screenW, screenH) + position;
+    glm::dvec2 left_top     = ScreenToWorld(0, 0)             + glm::dvec2(position);
+    glm::dvec2 right_bottom = ScreenToWorld(screenW, screenH) + glm::dvec2(position);
+    glm::dvec2 center       = (left_top + right_bottom) * 0.5;
 
-    projection = glm::ortho(left_top.x, right_bottom.x, right_bottom.y, left_top.y, -1.0f, 1.0f);
+    if(std::fabs(center.x - origin.x) * zoom > REBASE_PIXELS ||
+       std::fabs(center.y - origin.y) * zoom > REBASE_PIXELS)
+    {
+        origin = center;
+        rebaseCount++;
+    }
+
+    glm::vec2 half = glm::vec2((right_bottom - left_top) * 0.5);
+    projection = glm::ortho(-half.x, half.x, half.y, -half.y, -1.0f, 1.0f);
+    residual   = glm::vec2(center - origin);
+
+    viewMin = left_top;
+    viewMax = right_bottom;
 }
 
 /*
@@ -28,9 +42,9 @@ void Camera::updateProjectionMatrix (GLuint screenW, GLuint screenH)
  */
 
 // Transform world-space coordinates to screen-space
-glm::vec2 Camera::WorldToScreen (float worldX, float worldY) const
+glm::dvec2 Camera::WorldToScreen (double worldX, double worldY) const
 {
-    return glm::vec2
+    return glm::dvec2
     (
         (worldX - offset.x) * zoom,
         (worldY - offset.y) * zoom
@@ -38,9 +52,9 @@ glm::vec2 Camera::WorldToScreen (float worldX, float worldY) const
 }
 
 // Transform screen-space coordinates to world-space
-glm::vec2 Camera::ScreenToWorld (float screenX, float screenY) const
+glm::dvec2 Camera::ScreenToWorld (double screenX, double screenY) const
 {
-    return glm::vec2
+    return glm::dvec2
     (
         (screenX / zoom) + offset.x,
         (screenY / zoom) + offset.y
@@ -71,11 +85,11 @@ void Camera::update_pan (float screenX, float screenY)
 // Zoom the camera on screen-space coordinates by the given offset
 void Camera::zoom_on_position (float screenX, float screenY, float yOffset)
 {
-    glm::vec2 before_zoom = ScreenToWorld(screenX, screenY);
+    glm::dvec2 before_zoom = ScreenToWorld(screenX, screenY);
 
     zoom_by(yOffset);
 
-    glm::vec2 after_zoom = ScreenToWorld(screenX, screenY);
+    glm::dvec2 after_zoom = ScreenToWorld(screenX, screenY);
 
     offset.x += (before_zoom.x - after_zoom.x);
     offset.y += (before_zoom.y - after_zoom.y);
@@ -129,6 +143,11 @@ void ClassManager::ImGui_printClassData (const char* nodelabel, const char* type
         ImGui_printLabel(color, "Y", std::to_string(position.y).c_str());
         ImGui_printLabel(color, "zoom", std::to_string(camera.getZoom()).c_str());
 
+        const glm::dvec2& origin = camera.getOrigin();
+        std::string str_origin = std::to_string(origin.x) + ", " + std::to_string(origin.y) + " (" +
+                                 std::to_string(camera.getRebaseCount()) + " rebases)";
+        ImGui_printLabel(color, "origin", str_origin.c_str());
+
         ImGui::TreePop();
     }
     ImGui::PopID();
@@ -52,6 +52,12 @@ void Container::update_VBO ()
     }
 }
 
+void Container::update_VBO (GLsizei first, GLsizei count)
+{
+    bind_VBO();
+    glBufferSubData(GL_ARRAY_BUFFER, first * sizeof(GLfloat), count * sizeof(GLfloat), vertices + first);
+}
+
 void Container::update_EBO ()
 {
     bind_EBO();
@@ -0,0 +1,261 @@
+#include "include/curvesampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+static constexpr double PI = 3.14159265358979323846;
+
+// Splits "x(t), y(t)" at its only comma outside of parentheses
+static void split_pair (const std::string& func, std::string& x, std::string& y)
+{
+    size_t comma = std::string::npos;
+    int depth = 0;
+    for(size_t i = 0; i < func.size(); i++)
+    {
+        if(func[i] == '(')
+            depth++;
+        else if(func[i] == ')')
+            depth--;
+        else if(func[i] == ',' && depth == 0)
+        {
+            if(comma != std::string::npos)
+                comma = func.size(); // more than two coordinates
+            else
+                comma = i;
+        }
+    }
+
+    if(comma == std::string::npos || comma == func.size())
+        throw mu::Parser::exception_type("a parametric curve is written \"x(t), y(t)\"");
+
+    x = func.substr(0, comma);
+    y = func.substr(comma + 1);
+}
+
+/*
+ *
+ * CurveSampler
+ *
+ */
+
+CurveSampler::CurveSampler (Kind _kind)
+    : kind(_kind)
+{
+    T.resize(MAX_POINTS);
+    X.resize(MAX_POINTS);
+    Y.resize(MAX_POINTS);
+
+    if(kind == Parametric)
+    {
+        setFunction("5 * cos(3 * t), 5 * sin(2 * t)"); // Lissajous figure
+        setRange(0.0, 2.0 * PI);
+    }
+    else
+    {
+        setFunction("t / 2"); // Archimedean spiral
+        setRange(0.0, 6.0 * PI);
+    }
+}
+
+/*
+ *
+ * Function
+ *
+ */
+
+void CurveSampler::setFunction (const char* func)
+{
+    setFunctions({func});
+}
+
+// Throws mu::Parser::exception_type and keeps the previous functions if any new one is invalid
+void CurveSampler::setFunctions (const std::vector<std::string>& funcs)
+{
+    if(funcs.empty())
+        throw mu::Parser::exception_type("no function");
+
+    std::vector<std::unique_ptr<Program>> compiled;
+    for(const std::string& func : funcs)
+    {
+        compiled.emplace_back(new Program);
+        bind(*compiled.back(), func);
+        compiled.back()->x.Eval();
+        if(kind == Parametric)
+            compiled.back()->y.Eval();
+    }
+
+    functions = funcs;
+    programs.swap(compiled);
+}
+
+void CurveSampler::setRange (double _tMin, double _tMax)
+{
+    tMin = std::min(_tMin, _tMax);
+    tMax = std::max(_tMin, _tMax);
+}
+
+// Binds the parsers of a curve to the parameters
+void CurveSampler::bind (Program& program, const std::string& func)
+{
+    program.x.DefineVar("t", T.data());
+    program.y.DefineVar("t", T.data());
+
+    if(kind == Parametric)
+    {
+        std::string x, y;
+        split_pair(func, x, y);
+        program.x.SetExpr(x);
+        program.y.SetExpr(y);
+    }
+    else
+    {
+        program.x.SetExpr(func);
+    }
+}
+
+/*
+ *
+ * Sampling
+ *
+ */
+
+void CurveSampler::sample (double originX, double originY, float ratioX, float ratioY, float zoom)
+{
+    vertices.clear();
+    stripFirst.clear();
+    stripCount.clear();
+    curveFirst.clear();
+
+    if(!(tMax > tMin))
+        return;
+
+    const double scaleX = std::fabs(ratioX * zoom); // function units to pixels
+    const double scaleY = std::fabs(ratioY * zoom);
+
+    for(std::unique_ptr<Program>& program : programs)
+    {
+        int count = PILOT_POINTS;
+        for(int i = 0; i < count; i++)
+            T[i] = tMin + (tMax - tMin) * i / (count - 1);
+        evaluate(*program, count);
+
+        for(int pass = 1; pass < PASSES; pass++)
+        {
+            const double pixels = measureLength(count, scaleX, scaleY) / spacing / (1.0 - UNIFORM_SHARE);
+            const int next = static_cast<int>(std::max(16.0, std::min(static_cast<double>(MAX_POINTS), std::ceil(pixels) + 1.0)));
+
+            place(count, next);
+            count = next;
+            evaluate(*program, count);
+        }
+
+        curveFirst.push_back(static_cast<int>(vertices.size() / 2));
+        emit(count, originX, originY, ratioX, ratioY);
+    }
+}
+
+// X[i], Y[i] = the point of the curve at T[i], i = [0, count)
+void CurveSampler::evaluate (Program& program, int count)
+{
+    program.x.Eval(X.data(), count);
+
+    if(kind == Parametric)
+    {
+        program.y.Eval(Y.data(), count);
+        return;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+        const double r = X[i];
+        X[i] = r * std::cos(T[i]);
+        Y[i] = r * std::sin(T[i]);
+    }
+}
+
+// Cumulative screen-space length of the samples into "measure", a non-finite sample
+// adds nothing. Returns the whole length in pixels
+double CurveSampler::measureLength (int count, double scaleX, double scaleY)
+{
+    measure.resize(count);
+    measure[0] = 0.0;
+    for(int i = 1; i < count; i++)
+    {
+        const double dx = (X[i] - X[i - 1]) * scaleX;
+        const double dy = (Y[i] - Y[i - 1]) * scaleY;
+        const double length = std::hypot(dx, dy);
+        measure[i] = measure[i - 1] + (std::isfinite(length) ? length : 0.0);
+    }
+    return measure[count - 1];
+}
+
+// Replaces the parameters with "next" ones at equal steps of the measure, a mix of
+// the arc length and of t weighted by UNIFORM_SHARE
+void CurveSampler::place (int count, int next)
+{
+    const double length = measure[count - 1];
+    const double uniform = (length > 0.0) ? length * UNIFORM_SHARE / (1.0 - UNIFORM_SHARE) : 1.0;
+    for(int i = 0; i < count; i++)
+        measure[i] += uniform * (T[i] - tMin) / (tMax - tMin);
+
+    const double total = measure[count - 1];
+
+    nextT.resize(next);
+    int i = 0;
+    for(int k = 0; k < next; k++)
+    {
+        const double target = total * k / (next - 1);
+        while(i < count - 2 && measure[i + 1] < target)
+            i++;
+
+        const double width = measure[i + 1] - measure[i];
+        const double f = (width > 0.0) ? std::min(1.0, std::max(0.0, (target - measure[i]) / width)) : 0.0;
+        nextT[k] = T[i] + (T[i + 1] - T[i]) * f;
+    }
+    nextT[0] = tMin;
+    nextT[next - 1] = tMax;
+
+    std::copy(nextT.begin(), nextT.end(), T.begin());
+}
+
+// Converts the samples into vertices appended to the previous curves, one line strip per continuous piece
+void CurveSampler::emit (int count, double originX, double originY, float ratioX, float ratioY)
+{
+    int first = static_cast<int>(vertices.size() / 2);
+    auto close_strip = [&]()
+    {
+        const int vertexCount = static_cast<int>(vertices.size() / 2) - first;
+        if(vertexCount >= 2)
+        {
+            stripFirst.push_back(first);
+            stripCount.push_back(vertexCount);
+        }
+        else
+        {
+            vertices.resize(first * 2); // a single vertex draws nothing
+        }
+        first = static_cast<int>(vertices.size() / 2);
+    };
+
+    for(int i = 0; i < count; i++)
+    {
+        const float vx = static_cast<float>(originX + X[i] * ratioX);
+        const float vy = static_cast<float>(originY + Y[i] * ratioY);
+
+        if(std::isfinite(vx) && std::isfinite(vy))
+        {
+            vertices.push_back(vx);
+            vertices.push_back(vy);
+        }
+        else
+        {
+            close_strip();
+        }
+    }
+    close_strip();
+}
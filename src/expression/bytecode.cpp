@@ -0,0 +1,370 @@
+#include "../include/expression/bytecode.hpp"
+#include <cmath>
+#include <cstring>
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+static double pow_callback (double a, double b) { return std::pow(a, b); }
+
+// Change of the scalar stack depth caused by an instruction
+static int stack_effect (Bytecode::Opcode op)
+{
+    switch(op)
+    {
+    case Bytecode::Const: case Bytecode::X: case Bytecode::Var: case Bytecode::Load:
+        return 1;
+    case Bytecode::Call1: case Bytecode::Store: case Bytecode::EndIf:
+        return 0;
+    default: // binary operators, Call2, If and Else (the then-value is dropped on the else path)
+        return -1;
+    }
+}
+
+static int stack_size (const std::vector<Bytecode::Instruction>& code)
+{
+    int depth = 0;
+    int size = 0;
+    for(const Bytecode::Instruction& ins : code)
+    {
+        depth += stack_effect(ins.op);
+        if(depth > size)
+            size = depth;
+    }
+    return size;
+}
+
+// Runs "code" with the given stack and temporaries, returns the bottom of the stack
+static double run_code (const std::vector<Bytecode::Instruction>& code, double x, double* stack, double* temps)
+{
+    int top = -1;
+    const int count = (int)code.size();
+    for(int i = 0; i < count; i++)
+    {
+        const Bytecode::Instruction& ins = code[i];
+        switch(ins.op)
+        {
+        case Bytecode::Const: stack[++top] = ins.value;       break;
+        case Bytecode::X:     stack[++top] = x;               break;
+        case Bytecode::Var:   stack[++top] = *ins.var;        break;
+        case Bytecode::Load:  stack[++top] = temps[ins.slot]; break;
+        case Bytecode::Store: temps[ins.slot] = stack[top];   break;
+
+        case Bytecode::Add: top--; stack[top] = stack[top] +  stack[top + 1]; break;
+        case Bytecode::Sub: top--; stack[top] = stack[top] -  stack[top + 1]; break;
+        case Bytecode::Mul: top--; stack[top] = stack[top] *  stack[top + 1]; break;
+        case Bytecode::Div: top--; stack[top] = stack[top] /  stack[top + 1]; break;
+        case Bytecode::LT:  top--; stack[top] = stack[top] <  stack[top + 1]; break;
+        case Bytecode::LE:  top--; stack[top] = stack[top] <= stack[top + 1]; break;
+        case Bytecode::GT:  top--; stack[top] = stack[top] >  stack[top + 1]; break;
+        case Bytecode::GE:  top--; stack[top] = stack[top] >= stack[top + 1]; break;
+        case Bytecode::EQ:  top--; stack[top] = stack[top] == stack[top + 1]; break;
+        case Bytecode::NEQ: top--; stack[top] = stack[top] != stack[top + 1]; break;
+        case Bytecode::And: top--; stack[top] = stack[top] && stack[top + 1]; break;
+        case Bytecode::Or:  top--; stack[top] = stack[top] || stack[top + 1]; break;
+
+        case Bytecode::Pow:
+        case Bytecode::Call2: top--; stack[top] = ins.fn2(stack[top], stack[top + 1]); break;
+        case Bytecode::Call1:        stack[top] = ins.fn1(stack[top]);                 break;
+
+        case Bytecode::If:
+            if(stack[top--] == 0)
+                i = ins.jump - 1;
+            break;
+        case Bytecode::Else:
+            i = ins.jump - 1;
+            break;
+        case Bytecode::EndIf:
+            break;
+        }
+    }
+
+    return stack[0];
+}
+
+static Bytecode::Function function_from_name (const std::string& name)
+{
+    static const struct { const char* name; Bytecode::Function func; } table[] =
+    {
+        {"sin",   Bytecode::Sin},   {"cos",   Bytecode::Cos},   {"tan",   Bytecode::Tan},
+        {"asin",  Bytecode::ASin},  {"acos",  Bytecode::ACos},  {"atan",  Bytecode::ATan},
+        {"sinh",  Bytecode::Sinh},  {"cosh",  Bytecode::Cosh},  {"tanh",  Bytecode::Tanh},
+        {"asinh", Bytecode::ASinh}, {"acosh", Bytecode::ACosh}, {"atanh", Bytecode::ATanh},
+        {"log",   Bytecode::Log},   {"ln",    Bytecode::Log},   {"log2",  Bytecode::Log2},
+        {"log10", Bytecode::Log10}, {"exp",   Bytecode::Exp},   {"sqrt",  Bytecode::Sqrt},
+        {"abs",   Bytecode::Abs},   {"sign",  Bytecode::Sign},  {"rint",  Bytecode::Rint}
+    };
+
+    for(const auto& entry : table)
+        if(name == entry.name)
+            return entry.func;
+
+    return Bytecode::Other;
+}
+
+// Infix operators are not listed by GetFunDef(), so the default ones are recognized by address
+static Bytecode::Function function_from_address (const mu::ParserBase& parser, void* address)
+{
+    if(address == reinterpret_cast<void*>(&mu::MathImpl<mu::value_type>::UnaryMinus)) return Bytecode::Neg;
+    if(address == reinterpret_cast<void*>(&mu::MathImpl<mu::value_type>::UnaryPlus))  return Bytecode::Plus;
+
+    for(const auto& fun : parser.GetFunDef())
+        if(fun.second.GetAddr() == address)
+            return function_from_name(fun.first);
+
+    return Bytecode::Other;
+}
+
+/*
+ *
+ * Bytecode
+ *
+ */
+
+const char* Bytecode::getFunctionName (Function func)
+{
+    static const char* const names[] =
+    {
+        "<fn>",
+        "-", "+",
+        "sin", "cos", "tan", "asin", "acos", "atan",
+        "sinh", "cosh", "tanh", "asinh", "acosh", "atanh",
+        "log", "log2", "log10", "exp", "sqrt", "abs", "sign", "rint"
+    };
+    return names[func];
+}
+
+void Bytecode::clear ()
+{
+    instructions.clear();
+    stackSize = 0;
+    tempCount = 0;
+    depth = 0;
+
+    prologue.clear();
+    cells.clear();
+    prologueStackSize = 0;
+}
+
+void Bytecode::push (const Instruction& instruction)
+{
+    depth += stack_effect(instruction.op);
+
+    if(depth > stackSize)
+        stackSize = depth;
+
+    instructions.push_back(instruction);
+}
+
+bool Bytecode::load (const mu::ParserBase& parser, const double* X)
+{
+    clear();
+    error.clear();
+
+    const mu::ParserByteCode& rpn = parser.GetByteCode();
+    const mu::SToken* tokens = rpn.GetBase();
+
+    std::vector<int> branches; // indices of the open If/Else instructions
+
+    auto var = [&](const double* ptr)
+    {
+        Instruction ins;
+        if(ptr == X)
+        {
+            ins.op = Bytecode::X;
+        }
+        else
+        {
+            ins.op = Var;
+            ins.var = ptr;
+        }
+        return ins;
+    };
+    auto op = [](Opcode opcode)
+    {
+        Instruction ins;
+        ins.op = opcode;
+        return ins;
+    };
+    auto constant = [](double value)
+    {
+        Instruction ins;
+        ins.op = Const;
+        ins.value = value;
+        return ins;
+    };
+
+    for(const mu::SToken* tok = tokens; tok->Cmd != mu::cmEND; tok++)
+    {
+        switch(tok->Cmd)
+        {
+        case mu::cmVAL: push(constant(tok->Val.data2)); break;
+        case mu::cmVAR: push(var(tok->Val.ptr));         break;
+
+        case mu::cmVARPOW2:
+        case mu::cmVARPOW3:
+        case mu::cmVARPOW4:
+        {
+            const int power = 2 + (tok->Cmd - mu::cmVARPOW2);
+            push(var(tok->Val.ptr));
+            for(int i = 1; i < power; i++)
+            {
+                push(var(tok->Val.ptr));
+                push(op(Mul));
+            }
+            break;
+        }
+
+        case mu::cmVARMUL: // ptr * data + data2
+            push(var(tok->Val.ptr));
+            push(constant(tok->Val.data));
+            push(op(Mul));
+            push(constant(tok->Val.data2));
+            push(op(Add));
+            break;
+
+        case mu::cmADD:  push(op(Add)); break;
+        case mu::cmSUB:  push(op(Sub)); break;
+        case mu::cmMUL:  push(op(Mul)); break;
+        case mu::cmDIV:  push(op(Div)); break;
+        case mu::cmLT:   push(op(LT));  break;
+        case mu::cmLE:   push(op(LE));  break;
+        case mu::cmGT:   push(op(GT));  break;
+        case mu::cmGE:   push(op(GE));  break;
+        case mu::cmEQ:   push(op(EQ));  break;
+        case mu::cmNEQ:  push(op(NEQ)); break;
+        case mu::cmLAND: push(op(And)); break;
+        case mu::cmLOR:  push(op(Or));  break;
+
+        case mu::cmPOW:
+        {
+            Instruction ins = op(Pow);
+            ins.fn2 = pow_callback;
+            push(ins);
+            break;
+        }
+
+        case mu::cmIF:
+            branches.push_back((int)instructions.size());
+            push(op(If));
+            break;
+
+        case mu::cmELSE:
+            if(branches.empty())
+            {
+                error = "unbalanced if-then-else";
+                clear();
+                return false;
+            }
+            instructions[branches.back()].jump = (int)instructions.size() + 1; // first instruction of the else branch
+            branches.back() = (int)instructions.size();
+            push(op(Else));
+            break;
+
+        case mu::cmENDIF:
+            if(branches.empty())
+            {
+                error = "unbalanced if-then-else";
+                clear();
+                return false;
+            }
+            instructions[branches.back()].jump = (int)instructions.size();
+            branches.pop_back();
+            push(op(EndIf));
+            break;
+
+        case mu::cmFUNC:
+        {
+            const mu::generic_callable_type& cb = tok->Fun.cb;
+            if(cb._pUserData != nullptr || (tok->Fun.argc != 1 && tok->Fun.argc != 2))
+            {
+                error = "unsupported function signature";
+                clear();
+                return false;
+            }
+
+            void* address = reinterpret_cast<void*>(cb._pRawFun);
+
+            Instruction ins;
+            if(tok->Fun.argc == 1)
+            {
+                ins.op   = Call1;
+                ins.fn1  = reinterpret_cast<Function1>(cb._pRawFun);
+                ins.func = function_from_address(parser, address);
+            }
+            else
+            {
+                ins.op  = Call2;
+                ins.fn2 = reinterpret_cast<Function2>(cb._pRawFun);
+            }
+            push(ins);
+            break;
+        }
+
+        default: // strings, bulk functions, assignments, user defined operators
+            error = "unsupported token (" + std::to_string((int)tok->Cmd) + ")";
+            clear();
+            return false;
+        }
+    }
+
+    if(!branches.empty() || depth != 1)
+    {
+        error = "expression does not produce a single value";
+        clear();
+        return false;
+    }
+
+    return true;
+}
+
+void Bytecode::assign
+(
+    const std::vector<Instruction>& _instructions,
+    const std::vector<Instruction>& _prologue,
+    int _tempCount, int cellCount
+)
+{
+    instructions = _instructions;
+    stackSize = stack_size(instructions);
+    tempCount = _tempCount;
+    depth = 1;
+
+    prologue = _prologue;
+    prologueStackSize = stack_size(prologue);
+    cells.assign(cellCount, 0.0);
+
+    for(Instruction& ins : instructions)
+        if(ins.op == Var && ins.var == nullptr)
+            ins.var = &cells[ins.slot];
+
+    prepare();
+}
+
+void Bytecode::prepare ()
+{
+    if(prologue.empty())
+        return;
+
+    std::vector<double> stack(prologueStackSize);
+    run_code(prologue, 0.0, stack.data(), cells.data());
+}
+
+double Bytecode::eval (double x) const
+{
+    double stackBuffer[64];
+    double temps[MAX_TEMPS];
+    std::vector<double> heapStack;
+
+    double* stack = stackBuffer;
+    if(stackSize > 64)
+    {
+        heapStack.resize(stackSize);
+        stack = heapStack.data();
+    }
+
+    return run_code(instructions, x, stack, temps);
+}
@@ -0,0 +1,245 @@
+#include "../include/expression/dual.hpp"
+#include <cmath>
+#include <limits>
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+static constexpr double LN2  = 0.69314718055994530942;
+static constexpr double LN10 = 2.30258509299404568402;
+
+// Deepest stack eval() supports
+static constexpr int MAX_STACK = 64;
+
+static Dual constant (double value)
+{
+    return {value, 0.0, 0.0};
+}
+
+// g(a) for g with derivatives g1 = g'(a.value), g2 = g''(a.value)
+static Dual chain (double value, double g1, double g2, const Dual& a)
+{
+    return {value, g1 * a.d1, g2 * a.d1 * a.d1 + g1 * a.d2};
+}
+
+static Dual dual_mul (const Dual& a, const Dual& b)
+{
+    return {a.value * b.value,
+            a.d1 * b.value + a.value * b.d1,
+            a.d2 * b.value + 2.0 * a.d1 * b.d1 + a.value * b.d2};
+}
+
+static Dual dual_div (const Dual& a, const Dual& b)
+{
+    const double q  = a.value / b.value;
+    const double q1 = (a.d1 - q * b.d1) / b.value;
+    const double q2 = (a.d2 - 2.0 * q1 * b.d1 - q * b.d2) / b.value;
+    return {q, q1, q2};
+}
+
+static Dual dual_pow (const Bytecode::Instruction& ins, const Dual& a, const Dual& b)
+{
+    const double f = ins.fn2(a.value, b.value);
+
+    // constant exponent, also defined for a negative base
+    if(b.d1 == 0.0 && b.d2 == 0.0)
+    {
+        if(b.value == 0.0)
+            return constant(f);
+        const double g1 = b.value * std::pow(a.value, b.value - 1.0);
+        const double g2 = (b.value == 1.0) ? 0.0 : b.value * (b.value - 1.0) * std::pow(a.value, b.value - 2.0);
+        return chain(f, g1, g2, a);
+    }
+
+    // a^b = exp(b ln a)
+    const double lna = std::log(a.value);
+    const double u1 = b.d1 * lna + b.value * a.d1 / a.value;
+    const double u2 = b.d2 * lna + 2.0 * b.d1 * a.d1 / a.value + b.value * (a.d2 / a.value - (a.d1 * a.d1) / (a.value * a.value));
+    return {f, f * u1, f * (u2 + u1 * u1)};
+}
+
+// Central differences, for the functions known only by their address
+static Dual numeric1 (const Bytecode::Instruction& ins, const Dual& a)
+{
+    const double x  = a.value;
+    const double fx = ins.fn1(x);
+    const double h1 = std::cbrt(std::numeric_limits<double>::epsilon()) * std::fmax(1.0, std::fabs(x));
+    const double h2 = std::sqrt(std::sqrt(std::numeric_limits<double>::epsilon())) * std::fmax(1.0, std::fabs(x));
+
+    const double g1 = (ins.fn1(x + h1) - ins.fn1(x - h1)) / (2.0 * h1);
+    const double g2 = (ins.fn1(x + h2) - 2.0 * fx + ins.fn1(x - h2)) / (h2 * h2);
+    return chain(fx, g1, g2, a);
+}
+
+static Dual numeric2 (const Bytecode::Instruction& ins, const Dual& a, const Dual& b)
+{
+    const double fx = ins.fn2(a.value, b.value);
+    const double ha = std::cbrt(std::numeric_limits<double>::epsilon()) * std::fmax(1.0, std::fabs(a.value));
+    const double hb = std::cbrt(std::numeric_limits<double>::epsilon()) * std::fmax(1.0, std::fabs(b.value));
+
+    const double fa = (ins.fn2(a.value + ha, b.value) - ins.fn2(a.value - ha, b.value)) / (2.0 * ha);
+    const double fb = (ins.fn2(a.value, b.value + hb) - ins.fn2(a.value, b.value - hb)) / (2.0 * hb);
+
+    // the second partial derivatives are not estimated, f'' is only known when neither argument moves
+    const bool still = (a.d1 == 0.0 && b.d1 == 0.0);
+    const double d2 = still ? fa * a.d2 + fb * b.d2 : std::numeric_limits<double>::quiet_NaN();
+    return {fx, fa * a.d1 + fb * b.d1, d2};
+}
+
+static Dual call1 (const Bytecode::Instruction& ins, const Dual& a)
+{
+    const double x = a.value;
+    const double f = ins.fn1(x);
+
+    switch(ins.func)
+    {
+    case Bytecode::Plus: return a;
+    case Bytecode::Neg:  return {-a.value, -a.d1, -a.d2};
+    case Bytecode::Abs:
+    {
+        const double s = (x > 0.0) - (x < 0.0);
+        return {f, s * a.d1, s * a.d2};
+    }
+    case Bytecode::Sign:
+    case Bytecode::Rint: return constant(f);
+
+    case Bytecode::Sin:  return chain(f,  std::cos(x), -f, a);
+    case Bytecode::Cos:  return chain(f, -std::sin(x), -f, a);
+    case Bytecode::Tan:  return chain(f, 1.0 + f * f, 2.0 * f * (1.0 + f * f), a);
+    case Bytecode::Sinh: return chain(f, std::cosh(x), f, a);
+    case Bytecode::Cosh: return chain(f, std::sinh(x), f, a);
+    case Bytecode::Tanh: return chain(f, 1.0 - f * f, -2.0 * f * (1.0 - f * f), a);
+    case Bytecode::Exp:  return chain(f, f, f, a);
+
+    case Bytecode::ASin:
+    case Bytecode::ACos:
+    {
+        const double s = (ins.func == Bytecode::ASin) ? 1.0 : -1.0;
+        const double r = 1.0 / std::sqrt(1.0 - x * x);
+        return chain(f, s * r, s * x * r * r * r, a);
+    }
+    case Bytecode::ATan:
+    {
+        const double r = 1.0 / (1.0 + x * x);
+        return chain(f, r, -2.0 * x * r * r, a);
+    }
+    case Bytecode::ASinh:
+    case Bytecode::ACosh:
+    {
+        const double r = 1.0 / std::sqrt(ins.func == Bytecode::ASinh ? x * x + 1.0 : x * x - 1.0);
+        return chain(f, r, -x * r * r * r, a);
+    }
+    case Bytecode::ATanh:
+    {
+        const double r = 1.0 / (1.0 - x * x);
+        return chain(f, r, 2.0 * x * r * r, a);
+    }
+
+    case Bytecode::Log:
+    case Bytecode::Log2:
+    case Bytecode::Log10:
+    {
+        const double k = ins.func == Bytecode::Log ? 1.0 : ins.func == Bytecode::Log2 ? 1.0 / LN2 : 1.0 / LN10;
+        return chain(f, k / x, -k / (x * x), a);
+    }
+    case Bytecode::Sqrt:
+        return chain(f, 0.5 / f, -0.25 / (f * f * f), a);
+
+    default:
+        return numeric1(ins, a);
+    }
+}
+
+static Dual binary (const Bytecode::Instruction& ins, const Dual& a, const Dual& b)
+{
+    switch(ins.op)
+    {
+    case Bytecode::Add: return {a.value + b.value, a.d1 + b.d1, a.d2 + b.d2};
+    case Bytecode::Sub: return {a.value - b.value, a.d1 - b.d1, a.d2 - b.d2};
+    case Bytecode::Mul: return dual_mul(a, b);
+    case Bytecode::Div: return dual_div(a, b);
+    case Bytecode::Pow: return dual_pow(ins, a, b);
+
+    case Bytecode::LT:  return constant(a.value <  b.value);
+    case Bytecode::LE:  return constant(a.value <= b.value);
+    case Bytecode::GT:  return constant(a.value >  b.value);
+    case Bytecode::GE:  return constant(a.value >= b.value);
+    case Bytecode::EQ:  return constant(a.value == b.value);
+    case Bytecode::NEQ: return constant(a.value != b.value);
+    case Bytecode::And: return constant(a.value && b.value);
+    case Bytecode::Or:  return constant(a.value || b.value);
+
+    default: // Call2
+        return numeric2(ins, a, b);
+    }
+}
+
+/*
+ *
+ * DualEvaluator
+ *
+ */
+
+bool DualEvaluator::load (const Bytecode& _bytecode)
+{
+    bytecode.clear();
+    if(_bytecode.getStackSize() > MAX_STACK)
+        return false;
+
+    bytecode = _bytecode;
+    return !bytecode.empty();
+}
+
+void DualEvaluator::clear ()
+{
+    bytecode.clear();
+}
+
+Dual DualEvaluator::eval (double x) const
+{
+    if(bytecode.empty())
+        return constant(std::numeric_limits<double>::quiet_NaN());
+
+    Dual stack[MAX_STACK];
+    Dual temps[Bytecode::MAX_TEMPS];
+    int top = -1;
+
+    const std::vector<Bytecode::Instruction>& code = bytecode.getInstructions();
+    const int count = static_cast<int>(code.size());
+    for(int i = 0; i < count; i++)
+    {
+        const Bytecode::Instruction& ins = code[i];
+        switch(ins.op)
+        {
+        case Bytecode::Const: stack[++top] = constant(ins.value); break;
+        case Bytecode::X:     stack[++top] = {x, 1.0, 0.0};       break;
+        case Bytecode::Var:   stack[++top] = constant(*ins.var);  break; // x-invariant
+        case Bytecode::Load:  stack[++top] = temps[ins.slot];     break;
+        case Bytecode::Store: temps[ins.slot] = stack[top];       break;
+
+        case Bytecode::Call1:
+            stack[top] = call1(ins, stack[top]);
+            break;
+
+        case Bytecode::If: // the branch taken by the value
+            if(stack[top--].value == 0)
+                i = ins.jump - 1;
+            break;
+        case Bytecode::Else:
+            i = ins.jump - 1;
+            break;
+        case Bytecode::EndIf:
+            break;
+
+        default: // binary operators, Pow and Call2
+            top--;
+            stack[top] = binary(ins, stack[top], stack[top + 1]);
+            break;
+        }
+    }
+
+    return stack[0];
+}
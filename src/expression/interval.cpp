@@ -0,0 +1,384 @@
+#include "../include/expression/interval.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+static constexpr double INF = std::numeric_limits<double>::infinity();
+static constexpr double PI  = 3.14159265358979323846;
+
+// Deepest stack eval() supports, both branches of an if-then-else stay on it
+static constexpr int MAX_STACK = 64;
+
+// Rounds the bounds outwards, NaN bounds (inf - inf, ...) widen to infinity
+static Interval make (double lo, double hi)
+{
+    if(std::isnan(lo)) lo = -INF;
+    if(std::isnan(hi)) hi =  INF;
+    return {std::nextafter(lo, -INF), std::nextafter(hi, INF)};
+}
+
+// muParser computes the inverse hyperbolic functions through log(), which loses
+// digits to cancellation, their bounds get a wider margin
+static Interval make_loose (double lo, double hi)
+{
+    const double slack = 1e-9;
+    return make(lo - slack * (1.0 + std::fabs(lo)), hi + slack * (1.0 + std::fabs(hi)));
+}
+
+static Interval point (double value)
+{
+    return std::isnan(value) ? Interval::empty() : Interval{value, value};
+}
+
+static Interval hull (Interval a, Interval b)
+{
+    if(a.isEmpty()) return b;
+    if(b.isEmpty()) return a;
+    return {std::min(a.lo, b.lo), std::max(a.hi, b.hi)};
+}
+
+// 1 if every value is non-zero, 0 if all of them are zero, -1 if undecided
+static int truth (Interval a)
+{
+    if(a.lo > 0.0 || a.hi < 0.0)    return 1;
+    if(a.lo == 0.0 && a.hi == 0.0) return 0;
+    return -1;
+}
+
+static Interval boolean (int value)
+{
+    return value < 0 ? Interval{0.0, 1.0} : Interval{(double)value, (double)value};
+}
+
+// 0 * inf is 0 for the bounds of a product
+static double mul_bound (double a, double b)
+{
+    return (a == 0.0 || b == 0.0) ? 0.0 : a * b;
+}
+
+// Does [a.lo, a.hi] contain offset + k * period for some integer k,
+// the test errs on the side of yes
+static bool contains_periodic (Interval a, double offset, double period)
+{
+    const double slack = 1e-12 * (1.0 + std::fabs(a.lo) + std::fabs(a.hi));
+    const double k = std::floor((a.lo - offset) / period);
+    for(int i = 0; i < 3; i++)
+    {
+        const double p = offset + (k + i) * period;
+        if(p >= a.lo - slack && p <= a.hi + slack)
+            return true;
+    }
+    return false;
+}
+
+static Interval interval_abs (Interval a)
+{
+    if(a.lo >= 0.0) return a;
+    if(a.hi <= 0.0) return {-a.hi, -a.lo};
+    return {0.0, std::max(-a.lo, a.hi)};
+}
+
+static Interval interval_mul (Interval a, Interval b)
+{
+    const double p[] = {mul_bound(a.lo, b.lo), mul_bound(a.lo, b.hi), mul_bound(a.hi, b.lo), mul_bound(a.hi, b.hi)};
+    return make(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+}
+
+static Interval interval_div (Interval a, Interval b)
+{
+    if(b.lo == 0.0 && b.hi == 0.0)
+        return Interval::empty();
+    if(b.lo <= 0.0 && b.hi >= 0.0)
+        return Interval::entire();
+
+    // inf / inf is NaN, fmin and fmax take the other corners then
+    const double q[] = {a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi};
+    double lo = q[0], hi = q[0];
+    for(double v : q)
+    {
+        lo = std::fmin(lo, v);
+        hi = std::fmax(hi, v);
+    }
+    return make(lo, hi);
+}
+
+static Interval interval_pow (Interval a, Interval b)
+{
+    // integer powers are defined for negative bases
+    if(b.lo == b.hi && b.lo == std::rint(b.lo) && std::fabs(b.lo) < 1e15)
+    {
+        const double n = std::fabs(b.lo);
+        if(n == 0.0)
+            return {1.0, 1.0};
+
+        Interval base = a;
+        if(std::fmod(n, 2.0) == 0.0) // even powers of |a|
+            base = interval_abs(a);
+
+        const Interval p = make(std::pow(base.lo, n), std::pow(base.hi, n));
+        return b.lo < 0.0 ? interval_div({1.0, 1.0}, p) : p;
+    }
+
+    // a^b is monotone in each argument for a >= 0, the extremes lie on the corners
+    if(a.hi < 0.0)
+        return Interval::empty();
+    const double lo = std::max(a.lo, 0.0);
+
+    const double c[] = {std::pow(lo, b.lo), std::pow(lo, b.hi), std::pow(a.hi, b.lo), std::pow(a.hi, b.hi)};
+    double min = c[0], max = c[0];
+    for(double v : c)
+    {
+        min = std::fmin(min, v);
+        max = std::fmax(max, v);
+    }
+    return make(min, max);
+}
+
+static Interval compare (Bytecode::Opcode op, Interval a, Interval b)
+{
+    switch(op)
+    {
+    case Bytecode::LT: return boolean(a.hi <  b.lo ? 1 : a.lo >= b.hi ? 0 : -1);
+    case Bytecode::LE: return boolean(a.hi <= b.lo ? 1 : a.lo >  b.hi ? 0 : -1);
+    case Bytecode::GT: return boolean(a.lo >  b.hi ? 1 : a.hi <= b.lo ? 0 : -1);
+    case Bytecode::GE: return boolean(a.lo >= b.hi ? 1 : a.hi <  b.lo ? 0 : -1);
+
+    case Bytecode::EQ:
+    case Bytecode::NEQ:
+    {
+        int equal = -1;
+        if(a.lo == a.hi && b.lo == b.hi && a.lo == b.lo) equal = 1;
+        else if(a.hi < b.lo || b.hi < a.lo)              equal = 0;
+
+        if(op == Bytecode::NEQ && equal >= 0)
+            equal = 1 - equal;
+        return boolean(equal);
+    }
+
+    case Bytecode::And:
+    {
+        const int ta = truth(a), tb = truth(b);
+        return boolean((ta == 0 || tb == 0) ? 0 : (ta == 1 && tb == 1) ? 1 : -1);
+    }
+
+    default: // Or
+    {
+        const int ta = truth(a), tb = truth(b);
+        return boolean((ta == 1 || tb == 1) ? 1 : (ta == 0 && tb == 0) ? 0 : -1);
+    }
+    }
+}
+
+static Interval binary (const Bytecode::Instruction& ins, Interval a, Interval b)
+{
+    if(a.isEmpty() || b.isEmpty())
+        return Interval::empty();
+
+    switch(ins.op)
+    {
+    case Bytecode::Add: return make(a.lo + b.lo, a.hi + b.hi);
+    case Bytecode::Sub: return make(a.lo - b.hi, a.hi - b.lo);
+    case Bytecode::Mul: return interval_mul(a, b);
+    case Bytecode::Div: return interval_div(a, b);
+    case Bytecode::Pow: return interval_pow(a, b);
+
+    case Bytecode::Call2:
+        if(a.lo == a.hi && b.lo == b.hi)
+            return point(ins.fn2(a.lo, b.lo));
+        return Interval::entire();
+
+    default:
+        return compare(ins.op, a, b);
+    }
+}
+
+static Interval call1 (const Bytecode::Instruction& ins, Interval a)
+{
+    if(a.isEmpty())
+        return Interval::empty();
+
+    switch(ins.func)
+    {
+    case Bytecode::Plus: return a;
+    case Bytecode::Neg:  return {-a.hi, -a.lo};
+    case Bytecode::Abs:  return interval_abs(a);
+    case Bytecode::Sign:
+    case Bytecode::Rint: return {ins.fn1(a.lo), ins.fn1(a.hi)}; // exact and non-decreasing
+
+    case Bytecode::Exp:   return make(std::exp(a.lo),   std::exp(a.hi));
+    case Bytecode::ATan:  return make(std::atan(a.lo),  std::atan(a.hi));
+    case Bytecode::Sinh:  return make(std::sinh(a.lo),  std::sinh(a.hi));
+    case Bytecode::Tanh:  return make(std::tanh(a.lo),  std::tanh(a.hi));
+    case Bytecode::ASinh: return make_loose(ins.fn1(a.lo), ins.fn1(a.hi));
+
+    case Bytecode::Cosh:
+    {
+        const Interval m = interval_abs(a);
+        return make(std::cosh(m.lo), std::cosh(m.hi));
+    }
+
+    case Bytecode::Sqrt:
+        if(a.hi < 0.0)
+            return Interval::empty();
+        return make(std::sqrt(std::max(a.lo, 0.0)), std::sqrt(a.hi));
+
+    case Bytecode::Log:
+    case Bytecode::Log2:
+    case Bytecode::Log10:
+    {
+        if(a.hi <= 0.0)
+            return Interval::empty();
+        double (*f)(double) = ins.func == Bytecode::Log  ? static_cast<double (*)(double)>(std::log)
+                            : ins.func == Bytecode::Log2 ? static_cast<double (*)(double)>(std::log2)
+                            :                              static_cast<double (*)(double)>(std::log10);
+        return make(a.lo > 0.0 ? f(a.lo) : -INF, f(a.hi));
+    }
+
+    case Bytecode::ASin:
+    case Bytecode::ACos:
+    {
+        if(a.hi < -1.0 || a.lo > 1.0)
+            return Interval::empty();
+        const double lo = std::max(a.lo, -1.0);
+        const double hi = std::min(a.hi,  1.0);
+        return ins.func == Bytecode::ASin ? make(std::asin(lo), std::asin(hi))
+                                          : make(std::acos(hi), std::acos(lo));
+    }
+
+    case Bytecode::ACosh:
+        if(a.hi < 1.0)
+            return Interval::empty();
+        return make_loose(ins.fn1(std::max(a.lo, 1.0)), ins.fn1(a.hi));
+
+    case Bytecode::ATanh:
+        if(a.hi <= -1.0 || a.lo >= 1.0)
+            return Interval::empty();
+        return make_loose(a.lo <= -1.0 ? -INF : ins.fn1(a.lo), a.hi >= 1.0 ? INF : ins.fn1(a.hi));
+
+    case Bytecode::Sin:
+    case Bytecode::Cos:
+    {
+        if(!(a.hi - a.lo < 2.0 * PI))
+            return {-1.0, 1.0};
+
+        // sin peaks at pi/2 + 2k pi, cos at 2k pi
+        const double peak = ins.func == Bytecode::Sin ? 0.5 * PI : 0.0;
+        double (*f)(double) = ins.func == Bytecode::Sin ? static_cast<double (*)(double)>(std::sin)
+                                                        : static_cast<double (*)(double)>(std::cos);
+
+        Interval r = make(std::min(f(a.lo), f(a.hi)), std::max(f(a.lo), f(a.hi)));
+        if(contains_periodic(a, peak,      2.0 * PI)) r.hi =  1.0;
+        if(contains_periodic(a, peak + PI, 2.0 * PI)) r.lo = -1.0;
+        return {std::max(r.lo, -1.0), std::min(r.hi, 1.0)};
+    }
+
+    case Bytecode::Tan:
+        if(!(a.hi - a.lo < PI) || contains_periodic(a, 0.5 * PI, PI))
+            return Interval::entire();
+        return make(std::tan(a.lo), std::tan(a.hi));
+
+    default: // Other
+        if(a.lo == a.hi)
+            return point(ins.fn1(a.lo));
+        return Interval::entire();
+    }
+}
+
+// An empty condition is NaN everywhere, which counts as true
+static Interval select (Interval cond, Interval then, Interval otherwise)
+{
+    switch(cond.isEmpty() ? 1 : truth(cond))
+    {
+    case 1:  return then;
+    case 0:  return otherwise;
+    default: return hull(then, otherwise);
+    }
+}
+
+/*
+ *
+ * IntervalEvaluator
+ *
+ */
+
+bool IntervalEvaluator::load (const Bytecode& _bytecode, const double* Y)
+{
+    bytecode.clear();
+    varY = Y;
+
+    int depth = 0;
+    for(const Bytecode::Instruction& ins : _bytecode.getInstructions())
+    {
+        switch(ins.op)
+        {
+        case Bytecode::Const: case Bytecode::X: case Bytecode::Var: case Bytecode::Load:
+            depth++;
+            break;
+        case Bytecode::Call1: case Bytecode::Store: case Bytecode::Else:
+            break;
+        default:
+            depth--;
+            break;
+        }
+        if(depth > MAX_STACK)
+            return false;
+    }
+
+    bytecode = _bytecode;
+    return !bytecode.empty();
+}
+
+void IntervalEvaluator::clear ()
+{
+    bytecode.clear();
+}
+
+Interval IntervalEvaluator::eval (Interval x, Interval y) const
+{
+    if(bytecode.empty())
+        return Interval::entire();
+
+    Interval stack[MAX_STACK];
+    Interval conds[MAX_STACK];
+    Interval temps[Bytecode::MAX_TEMPS];
+    int top = -1;
+    int ctop = -1;
+
+    for(const Bytecode::Instruction& ins : bytecode.getInstructions())
+    {
+        switch(ins.op)
+        {
+        case Bytecode::Const: stack[++top] = point(ins.value); break;
+        case Bytecode::X:     stack[++top] = x;                break;
+        case Bytecode::Var:   stack[++top] = (ins.var == varY) ? y : point(*ins.var); break;
+        case Bytecode::Load:  stack[++top] = temps[ins.slot];  break;
+        case Bytecode::Store: temps[ins.slot] = stack[top];    break;
+
+        case Bytecode::Call1:
+            stack[top] = call1(ins, stack[top]);
+            break;
+
+        case Bytecode::If: // both branches are evaluated, like the SIMD kernels
+            conds[++ctop] = stack[top--];
+            break;
+        case Bytecode::Else:
+            break;
+        case Bytecode::EndIf:
+            top--;
+            stack[top] = select(conds[ctop--], stack[top], stack[top + 1]);
+            break;
+
+        default: // binary operators, Pow and Call2
+            top--;
+            stack[top] = binary(ins, stack[top], stack[top + 1]);
+            break;
+        }
+    }
+
+    return stack[0];
+}
@@ -0,0 +1,449 @@
+#include "../include/expression/jit.hpp"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define JIT_X86_64
+#endif
+
+/*
+ *
+ * Executable memory
+ *
+ */
+
+static void* alloc_pages (std::size_t size)
+{
+#if defined(_WIN32)
+    return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? nullptr : memory;
+#endif
+}
+
+static bool protect_pages (void* memory, std::size_t size)
+{
+#if defined(_WIN32)
+    DWORD old;
+    if(!VirtualProtect(memory, size, PAGE_EXECUTE_READ, &old))
+        return false;
+    FlushInstructionCache(GetCurrentProcess(), memory, size);
+    return true;
+#else
+    return mprotect(memory, size, PROT_READ | PROT_EXEC) == 0;
+#endif
+}
+
+static void free_pages (void* memory, std::size_t size)
+{
+#if defined(_WIN32)
+    VirtualFree(memory, 0, MEM_RELEASE);
+#else
+    munmap(memory, size);
+#endif
+}
+
+static std::size_t page_size ()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+#ifdef JIT_X86_64
+
+/*
+ *
+ * Emitter
+ *
+ */
+
+#if defined(_WIN32)
+static constexpr int32_t SHADOW_SPACE = 32; // home space for the callee's register arguments
+#else
+static constexpr int32_t SHADOW_SPACE = 0;
+#endif
+
+// SSE2 scalar opcodes (F2 0F xx)
+enum : uint8_t
+{
+    MOVSD_LOAD  = 0x10,
+    MOVSD_STORE = 0x11,
+    SQRTSD      = 0x51,
+    ADDSD       = 0x58,
+    MULSD       = 0x59,
+    SUBSD       = 0x5C,
+    DIVSD       = 0x5E,
+    CMPSD       = 0xC2
+};
+
+// cmpsd predicates
+enum : uint8_t
+{
+    CMP_EQ  = 0,
+    CMP_LT  = 1,
+    CMP_LE  = 2,
+    CMP_NEQ = 4
+};
+
+struct JitEmitter
+{
+    std::vector<uint8_t> code;
+
+    void byte  (uint8_t b)  { code.push_back(b); }
+    void bytes (std::initializer_list<uint8_t> b) { code.insert(code.end(), b); }
+
+    void imm32 (int32_t v)
+    {
+        uint8_t b[4];
+        std::memcpy(b, &v, 4);
+        code.insert(code.end(), b, b + 4);
+    }
+
+    void imm64 (uint64_t v)
+    {
+        uint8_t b[8];
+        std::memcpy(b, &v, 8);
+        code.insert(code.end(), b, b + 8);
+    }
+
+    // [rsp + disp32] operand for register "reg"
+    void rsp_operand (int reg, int32_t disp)
+    {
+        byte(0x84 | (reg << 3)); // mod = 10, rm = 100 (SIB)
+        byte(0x24);              // base = rsp, no index
+        imm32(disp);
+    }
+
+    // <op>sd xmm(reg), [rsp + disp]
+    void sse (uint8_t opcode, int reg, int32_t disp)
+    {
+        bytes({0xF2, 0x0F, opcode});
+        rsp_operand(reg, disp);
+    }
+
+    // cmp<pred>sd xmm(reg), [rsp + disp]
+    void cmpsd (int reg, int32_t disp, uint8_t predicate)
+    {
+        sse(CMPSD, reg, disp);
+        byte(predicate);
+    }
+
+    // mov rax, imm64
+    void mov_rax (uint64_t value)
+    {
+        bytes({0x48, 0xB8});
+        imm64(value);
+    }
+
+    void mov_rax (double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, 8);
+        mov_rax(bits);
+    }
+
+    // mov [rsp + disp], rax
+    void store_rax (int32_t disp)
+    {
+        bytes({0x48, 0x89});
+        rsp_operand(0, disp);
+    }
+
+    // movq xmm(reg), rax
+    void movq_xmm_rax (int reg)
+    {
+        bytes({0x66, 0x48, 0x0F, 0x6E, static_cast<uint8_t>(0xC0 | (reg << 3))});
+    }
+
+    // andpd / orpd / xorpd xmm0, xmm1
+    void andpd_01 () { bytes({0x66, 0x0F, 0x54, 0xC1}); }
+    void orpd_01  () { bytes({0x66, 0x0F, 0x56, 0xC1}); }
+    void xorpd_01 () { bytes({0x66, 0x0F, 0x57, 0xC1}); }
+
+    // xorpd xmm(reg), xmm(reg)
+    void zero (int reg) { bytes({0x66, 0x0F, 0x57, static_cast<uint8_t>(0xC0 | (reg << 3) | reg)}); }
+
+    // xmm0 = mask & 1.0
+    void mask_to_bool ()
+    {
+        mov_rax(1.0);
+        movq_xmm_rax(1);
+        andpd_01();
+    }
+
+    // call the function at "address", arguments in xmm0 (and xmm1)
+    void call (const void* address)
+    {
+        mov_rax(reinterpret_cast<uint64_t>(address));
+        bytes({0xFF, 0xD0}); // call rax
+    }
+
+    // returns the position of the rel32 to patch
+    int32_t jmp () { byte(0xE9);         int32_t at = (int32_t)code.size(); imm32(0); return at; }
+    int32_t je  () { bytes({0x0F, 0x84}); int32_t at = (int32_t)code.size(); imm32(0); return at; }
+
+    void patch (int32_t at, int32_t target)
+    {
+        const int32_t rel = target - (at + 4);
+        std::memcpy(&code[at], &rel, 4);
+    }
+};
+
+#endif /* JIT_X86_64 */
+
+/*
+ *
+ * JitFunction
+ *
+ */
+
+JitFunction::~JitFunction ()
+{
+    release();
+}
+
+void JitFunction::release ()
+{
+    if(memory != nullptr)
+        free_pages(memory, memorySize);
+
+    function = nullptr;
+    memory = nullptr;
+    memorySize = 0;
+    codeSize = 0;
+}
+
+bool JitFunction::compile (const Bytecode& bytecode)
+{
+    release();
+    error.clear();
+
+#ifndef JIT_X86_64
+    error = "the JIT only targets x86-64";
+    return false;
+#else
+    if(bytecode.empty())
+    {
+        error = "empty bytecode";
+        return false;
+    }
+
+    const std::vector<Bytecode::Instruction>& instructions = bytecode.getInstructions();
+    const int count = (int)instructions.size();
+
+    // slot 0 holds x, slots 1.. hold the value stack, followed by the temporaries
+    auto slot = [](int index) { return SHADOW_SPACE + 8 * index; };
+    auto top  = [&](int depth) { return slot(1 + depth); };
+    auto temp = [&](int index) { return slot(1 + bytecode.getStackSize() + index); };
+
+    int32_t frame = slot(1 + bytecode.getStackSize() + bytecode.getTempCount());
+    if(frame % 16 != 8) // rsp is 8 (mod 16) on entry, calls need it 16-byte aligned
+        frame += 8;
+
+    JitEmitter e;
+    std::vector<int32_t> offsets(count + 1);
+    std::vector<std::pair<int32_t, int>> patches; // rel32 position, target instruction
+
+    // prologue
+    e.bytes({0x48, 0x81, 0xEC}); e.imm32(frame); // sub rsp, frame
+    e.sse(MOVSD_STORE, 0, slot(0));              // x -> slot 0
+
+    int depth = -1; // index of the top of the stack
+    for(int i = 0; i < count; i++)
+    {
+        const Bytecode::Instruction& ins = instructions[i];
+        offsets[i] = (int32_t)e.code.size();
+
+        switch(ins.op)
+        {
+        case Bytecode::Const:
+            depth++;
+            e.mov_rax(ins.value);
+            e.store_rax(top(depth));
+            break;
+
+        case Bytecode::X:
+            depth++;
+            e.sse(MOVSD_LOAD,  0, slot(0));
+            e.sse(MOVSD_STORE, 0, top(depth));
+            break;
+
+        case Bytecode::Var:
+            depth++;
+            e.mov_rax(reinterpret_cast<uint64_t>(ins.var));
+            e.bytes({0xF2, 0x0F, 0x10, 0x00}); // movsd xmm0, [rax]
+            e.sse(MOVSD_STORE, 0, top(depth));
+            break;
+
+        case Bytecode::Load:
+            depth++;
+            e.sse(MOVSD_LOAD,  0, temp(ins.slot));
+            e.sse(MOVSD_STORE, 0, top(depth));
+            break;
+
+        case Bytecode::Store:
+            e.sse(MOVSD_LOAD,  0, top(depth));
+            e.sse(MOVSD_STORE, 0, temp(ins.slot));
+            break;
+
+        case Bytecode::Add:
+        case Bytecode::Sub:
+        case Bytecode::Mul:
+        case Bytecode::Div:
+        {
+            static const uint8_t opcodes[] = {ADDSD, SUBSD, MULSD, DIVSD};
+            depth--;
+            e.sse(MOVSD_LOAD, 0, top(depth));
+            e.sse(opcodes[ins.op - Bytecode::Add], 0, top(depth + 1));
+            e.sse(MOVSD_STORE, 0, top(depth));
+            break;
+        }
+
+        case Bytecode::LT:
+        case Bytecode::LE:
+        case Bytecode::EQ:
+        case Bytecode::NEQ:
+        {
+            const uint8_t predicate = ins.op == Bytecode::LT ? CMP_LT
+                                    : ins.op == Bytecode::LE ? CMP_LE
+                                    : ins.op == Bytecode::EQ ? CMP_EQ
+                                    :                          CMP_NEQ;
+            depth--;
+            e.sse(MOVSD_LOAD, 0, top(depth));
+            e.cmpsd(0, top(depth + 1), predicate);
+            e.mask_to_bool();
+            e.sse(MOVSD_STORE, 0, top(depth));
+            break;
+        }
+
+        case Bytecode::GT: // a > b  <=>  b < a
+        case Bytecode::GE:
+            depth--;
+            e.sse(MOVSD_LOAD, 0, top(depth + 1));
+            e.cmpsd(0, top(depth), ins.op == Bytecode::GT ? CMP_LT : CMP_LE);
+            e.mask_to_bool();
+            e.sse(MOVSD_STORE, 0, top(depth));
+            break;
+
+        case Bytecode::And:
+        case Bytecode::Or:
+            depth--;
+            e.zero(2);
+            e.sse(MOVSD_LOAD, 0, top(depth));
+            e.bytes({0xF2, 0x0F, 0xC2, 0xC2, CMP_NEQ}); // cmpneqsd xmm0, xmm2
+            e.sse(MOVSD_LOAD, 1, top(depth + 1));
+            e.bytes({0xF2, 0x0F, 0xC2, 0xCA, CMP_NEQ}); // cmpneqsd xmm1, xmm2
+            if(ins.op == Bytecode::And) e.andpd_01();
+            else                        e.orpd_01();
+            e.mask_to_bool();
+            e.sse(MOVSD_STORE, 0, top(depth));
+            break;
+
+        case Bytecode::Pow:
+        case Bytecode::Call2:
+            depth--;
+            e.sse(MOVSD_LOAD, 0, top(depth));
+            e.sse(MOVSD_LOAD, 1, top(depth + 1));
+            e.call(reinterpret_cast<const void*>(ins.fn2));
+            e.sse(MOVSD_STORE, 0, top(depth));
+            break;
+
+        case Bytecode::Call1:
+            switch(ins.func)
+            {
+            case Bytecode::Plus:
+                break;
+            case Bytecode::Neg:
+                e.sse(MOVSD_LOAD, 0, top(depth));
+                e.mov_rax(static_cast<uint64_t>(0x8000000000000000ull));
+                e.movq_xmm_rax(1);
+                e.xorpd_01();
+                e.sse(MOVSD_STORE, 0, top(depth));
+                break;
+            case Bytecode::Abs:
+                e.sse(MOVSD_LOAD, 0, top(depth));
+                e.mov_rax(static_cast<uint64_t>(0x7FFFFFFFFFFFFFFFull));
+                e.movq_xmm_rax(1);
+                e.andpd_01();
+                e.sse(MOVSD_STORE, 0, top(depth));
+                break;
+            case Bytecode::Sqrt:
+                e.sse(SQRTSD, 0, top(depth));
+                e.sse(MOVSD_STORE, 0, top(depth));
+                break;
+            default:
+                e.sse(MOVSD_LOAD, 0, top(depth));
+                e.call(reinterpret_cast<const void*>(ins.fn1));
+                e.sse(MOVSD_STORE, 0, top(depth));
+                break;
+            }
+            break;
+
+        case Bytecode::If:
+            // jump to the else branch if the condition equals zero (NaN is true, as in muParser)
+            e.sse(MOVSD_LOAD, 0, top(depth));
+            depth--;
+            e.zero(1);
+            e.bytes({0x66, 0x0F, 0x2E, 0xC1}); // ucomisd xmm0, xmm1
+            e.bytes({0x7A, 0x06});             // jp over the je (unordered)
+            patches.push_back({e.je(), ins.jump});
+            break;
+
+        case Bytecode::Else:
+            depth--; // the else branch writes its value to the same slot
+            patches.push_back({e.jmp(), ins.jump});
+            break;
+
+        case Bytecode::EndIf:
+            break;
+        }
+    }
+    offsets[count] = (int32_t)e.code.size();
+
+    // epilogue
+    e.sse(MOVSD_LOAD, 0, top(0));
+    e.bytes({0x48, 0x81, 0xC4}); e.imm32(frame); // add rsp, frame
+    e.byte(0xC3);                                // ret
+
+    for(const auto& p : patches)
+        e.patch(p.first, offsets[p.second]);
+
+    const std::size_t page = page_size();
+    const std::size_t size = (e.code.size() + page - 1) / page * page;
+
+    void* pages = alloc_pages(size);
+    if(pages == nullptr)
+    {
+        error = "failed to map memory";
+        return false;
+    }
+
+    std::memcpy(pages, e.code.data(), e.code.size());
+    if(!protect_pages(pages, size))
+    {
+        free_pages(pages, size);
+        error = "failed to make memory executable";
+        return false;
+    }
+
+    memory = pages;
+    memorySize = size;
+    codeSize = e.code.size();
+    function = reinterpret_cast<Function>(pages);
+    return true;
+#endif
+}
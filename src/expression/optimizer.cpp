@@ -0,0 +1,309 @@
+#include "../include/expression/optimizer.hpp"
+#include <algorithm>
+#include <cstring>
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+// Same semantics as the reference interpreter
+static double apply (const Bytecode::Instruction& ins, double a, double b)
+{
+    switch(ins.op)
+    {
+    case Bytecode::Add: return a +  b;
+    case Bytecode::Sub: return a -  b;
+    case Bytecode::Mul: return a *  b;
+    case Bytecode::Div: return a /  b;
+    case Bytecode::LT:  return a <  b;
+    case Bytecode::LE:  return a <= b;
+    case Bytecode::GT:  return a >  b;
+    case Bytecode::GE:  return a >= b;
+    case Bytecode::EQ:  return a == b;
+    case Bytecode::NEQ: return a != b;
+    case Bytecode::And: return a && b;
+    case Bytecode::Or:  return a || b;
+
+    case Bytecode::Pow:
+    case Bytecode::Call2: return ins.fn2(a, b);
+    case Bytecode::Call1: return ins.fn1(a);
+
+    default:
+        return a;
+    }
+}
+
+static bool commutative (Bytecode::Opcode op)
+{
+    return op == Bytecode::Add || op == Bytecode::Mul ||
+           op == Bytecode::EQ  || op == Bytecode::NEQ ||
+           op == Bytecode::And || op == Bytecode::Or;
+}
+
+/*
+ *
+ * Optimizer
+ *
+ */
+
+bool Optimizer::run (Bytecode& bytecode)
+{
+    nodes.clear();
+    unique.clear();
+    prologue.clear();
+    temps = 0;
+    cells = 0;
+    instructionsBefore = 0;
+    instructionsAfter = 0;
+    folded = 0;
+
+    if(bytecode.empty() || bytecode.getTempCount() > 0 || !bytecode.getPrologue().empty())
+        return false;
+
+    struct Branch
+    {
+        int cond;
+        int then;
+        int outer; // scope of the whole if-then-else
+    };
+
+    std::vector<int> stack;
+    std::vector<Branch> branches;
+    int scope = 0;
+    int scopes = 1;
+
+    auto pop = [&]()
+    {
+        const int top = stack.back();
+        stack.pop_back();
+        return top;
+    };
+
+    for(const Bytecode::Instruction& ins : bytecode.getInstructions())
+    {
+        Node node;
+        node.ins = ins;
+
+        switch(ins.op)
+        {
+        case Bytecode::Const:
+        case Bytecode::X:
+        case Bytecode::Var:
+            stack.push_back(add(node, scope));
+            break;
+
+        case Bytecode::Load:
+        case Bytecode::Store:
+            return false;
+
+        case Bytecode::Call1:
+            node.args[0] = pop();
+            node.argc = 1;
+            stack.push_back(add(node, scope));
+            break;
+
+        case Bytecode::If:
+            branches.push_back({pop(), -1, scope});
+            scope = scopes++;
+            break;
+
+        case Bytecode::Else:
+            branches.back().then = pop();
+            scope = scopes++;
+            break;
+
+        case Bytecode::EndIf:
+        {
+            const int otherwise = pop();
+            const Branch branch = branches.back();
+            branches.pop_back();
+            scope = branch.outer;
+            stack.push_back(select(branch.cond, branch.then, otherwise, scope));
+            break;
+        }
+
+        default: // binary operators, Pow and Call2
+            node.args[1] = pop();
+            node.args[0] = pop();
+            node.argc = 2;
+            stack.push_back(add(node, scope));
+            break;
+        }
+    }
+
+    const int root = stack.back();
+    count(root);
+
+    std::vector<Bytecode::Instruction> code;
+    emit(root, code, true);
+
+    instructionsBefore = static_cast<int>(bytecode.getInstructions().size());
+    instructionsAfter  = static_cast<int>(code.size());
+
+    bytecode.assign(code, prologue, temps, cells);
+    return true;
+}
+
+// Returns the node equal to "node" if there is one in the scope, adds it otherwise
+int Optimizer::add (Node node, int scope)
+{
+    const Bytecode::Opcode op = node.ins.op;
+
+    node.variant  = (op == Bytecode::X);
+    node.constant = (op == Bytecode::Const);
+    if(node.argc > 0)
+    {
+        node.constant = true;
+        for(int i = 0; i < node.argc; i++)
+        {
+            node.variant  = node.variant  || nodes[node.args[i]].variant;
+            node.constant = node.constant && nodes[node.args[i]].constant;
+        }
+        if(node.constant)
+            return fold(node);
+    }
+
+    if(node.argc == 0)
+        scope = -1; // leaves are never kept in a temporary
+    if(node.argc == 2 && commutative(op) && node.args[0] > node.args[1])
+        std::swap(node.args[0], node.args[1]);
+
+    unsigned long long bits;
+    std::memcpy(&bits, &node.ins.value, sizeof(bits));
+
+    const void* pointer = (op == Bytecode::Var)   ? static_cast<const void*>(node.ins.var)
+                        : (op == Bytecode::Call1) ? reinterpret_cast<const void*>(node.ins.fn1)
+                        :                           reinterpret_cast<const void*>(node.ins.fn2);
+
+    const Key key(op, node.ins.func, bits, pointer, node.args[0], node.args[1], node.args[2], scope);
+
+    const auto it = unique.find(key);
+    if(it != unique.end())
+        return it->second;
+
+    nodes.push_back(node);
+    const int id = static_cast<int>(nodes.size()) - 1;
+    unique.emplace(key, id);
+    return id;
+}
+
+int Optimizer::fold (const Node& node)
+{
+    const double a = nodes[node.args[0]].ins.value;
+    const double b = node.argc > 1 ? nodes[node.args[1]].ins.value : 0.0;
+
+    Node result;
+    result.ins.op = Bytecode::Const;
+    result.ins.value = apply(node.ins, a, b);
+    folded++;
+    return add(result, -1);
+}
+
+int Optimizer::select (int cond, int then, int otherwise, int scope)
+{
+    if(nodes[cond].constant)
+    {
+        folded++;
+        return nodes[cond].ins.value != 0 ? then : otherwise; // NaN counts as true
+    }
+    if(then == otherwise)
+        return then;
+
+    Node node;
+    node.ins.op = Bytecode::If;
+    node.args[0] = cond;
+    node.args[1] = then;
+    node.args[2] = otherwise;
+    node.argc = 3;
+    return add(node, scope);
+}
+
+// Computations that depend on other variables only, a bare variable is read directly
+bool Optimizer::hoistable (const Node& node) const
+{
+    return node.argc > 0 && !node.variant && !node.constant;
+}
+
+// Counts the references to every node reachable from "index" in the main code
+void Optimizer::count (int index)
+{
+    Node& node = nodes[index];
+    if(node.uses++ > 0 || hoistable(node))
+        return;
+
+    for(int i = 0; i < node.argc; i++)
+        count(node.args[i]);
+}
+
+// Emits the code of "index", reusing temporaries and hoisting invariants if "share" is set
+void Optimizer::emit (int index, std::vector<Bytecode::Instruction>& code, bool share)
+{
+    Node& node = nodes[index];
+
+    if(share && hoistable(node))
+    {
+        if(node.cell < 0)
+        {
+            node.cell = cells++;
+            emit(index, prologue, false);
+
+            Bytecode::Instruction store;
+            store.op = Bytecode::Store;
+            store.slot = node.cell;
+            prologue.push_back(store);
+        }
+
+        Bytecode::Instruction cell;
+        cell.op = Bytecode::Var; // bound to the cell by Bytecode::assign()
+        cell.slot = node.cell;
+        code.push_back(cell);
+        return;
+    }
+
+    if(share && node.slot >= 0)
+    {
+        Bytecode::Instruction load;
+        load.op = Bytecode::Load;
+        load.slot = node.slot;
+        code.push_back(load);
+        return;
+    }
+
+    if(node.ins.op == Bytecode::If)
+    {
+        emit(node.args[0], code, share);
+
+        const int branch = static_cast<int>(code.size());
+        code.push_back(node.ins);
+        emit(node.args[1], code, share);
+
+        const int skip = static_cast<int>(code.size());
+        Bytecode::Instruction ins;
+        ins.op = Bytecode::Else;
+        code.push_back(ins);
+        code[branch].jump = static_cast<int>(code.size()); // first instruction of the else branch
+        emit(node.args[2], code, share);
+
+        code[skip].jump = static_cast<int>(code.size());
+        ins.op = Bytecode::EndIf;
+        code.push_back(ins);
+    }
+    else
+    {
+        for(int i = 0; i < node.argc; i++)
+            emit(node.args[i], code, share);
+        code.push_back(node.ins);
+    }
+
+    if(share && node.uses > 1 && node.argc > 0 && temps < Bytecode::MAX_TEMPS)
+    {
+        node.slot = temps++;
+
+        Bytecode::Instruction store;
+        store.op = Bytecode::Store;
+        store.slot = node.slot;
+        code.push_back(store);
+    }
+}
@@ -0,0 +1,184 @@
+#include "../include/expression/simd.hpp"
+#include "../include/expression/simd_kernels.hpp"
+#include <cmath>
+#include <vector>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+// Both branches of an if-then-else stay on the stack, so the vector stack
+// grows at Else where the scalar one shrinks
+static bool vector_stack_size (const std::vector<Bytecode::Instruction>& code, int& stackSize, int& maskSize)
+{
+    int depth = 0;
+    int masks = 0;
+    stackSize = 0;
+    maskSize = 0;
+
+    for(const Bytecode::Instruction& ins : code)
+    {
+        switch(ins.op)
+        {
+        case Bytecode::Const: case Bytecode::X: case Bytecode::Var: case Bytecode::Load:
+            depth++;
+            break;
+        case Bytecode::Call1: case Bytecode::Store: case Bytecode::Else:
+            break;
+        case Bytecode::If:
+            depth--;
+            masks++;
+            break;
+        case Bytecode::EndIf:
+            depth--;
+            masks--;
+            break;
+        default:
+            depth--;
+            break;
+        }
+
+        if(depth > stackSize) stackSize = depth;
+        if(masks > maskSize)  maskSize  = masks;
+    }
+
+    return stackSize <= SimdEvaluator::MAX_STACK && maskSize <= SimdEvaluator::MAX_STACK;
+}
+
+/*
+ *
+ * SimdEvaluator
+ *
+ */
+
+SimdEvaluator::SimdEvaluator ()
+    : isa(detectIsa())
+{
+}
+
+SimdEvaluator::Isa SimdEvaluator::detectIsa ()
+{
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return AVX2;
+    return SSE2;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    int info[4];
+    __cpuid(info, 0);
+    if(info[0] >= 7)
+    {
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx     = (info[2] & (1 << 28)) != 0;
+        // the OS must save the ymm registers
+        if(osxsave && avx && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(info, 7, 0);
+            if(info[1] & (1 << 5))
+                return AVX2;
+        }
+    }
+    return SSE2;
+#else
+    return Scalar;
+#endif
+}
+
+const char* SimdEvaluator::getIsaName (Isa _isa)
+{
+    switch(_isa)
+    {
+    case Scalar: return "Scalar";
+    case SSE2:   return "SSE2";
+    case AVX2:   return "AVX2";
+    }
+    return "";
+}
+
+void SimdEvaluator::setIsa (Isa _isa)
+{
+    const Isa supported = detectIsa();
+    isa = (_isa > supported) ? supported : _isa;
+}
+
+bool SimdEvaluator::load (const Bytecode& _bytecode)
+{
+    bytecode.clear();
+    error.clear();
+
+    if(_bytecode.empty())
+    {
+        error = _bytecode.getError().empty() ? "no bytecode" : _bytecode.getError();
+        return false;
+    }
+
+    int stackSize, maskSize;
+    if(!vector_stack_size(_bytecode.getInstructions(), stackSize, maskSize))
+    {
+        error = "expression too deep (" + std::to_string(stackSize) + " values)";
+        return false;
+    }
+
+    bytecode = _bytecode;
+    return true;
+}
+
+void SimdEvaluator::clear ()
+{
+    bytecode.clear();
+}
+
+void SimdEvaluator::evalIsa (Isa _isa, const double* x, double* y, int count) const
+{
+    const std::vector<Bytecode::Instruction>& code = bytecode.getInstructions();
+
+    switch(_isa)
+    {
+    case AVX2:
+        simd_eval_avx2(code.data(), (int)code.size(), x, y, count);
+        break;
+    case SSE2:
+        simd_eval_sse2(code.data(), (int)code.size(), x, y, count);
+        break;
+    case Scalar:
+        for(int i = 0; i < count; i++)
+            y[i] = bytecode.eval(x[i]);
+        break;
+    }
+}
+
+void SimdEvaluator::eval (const double* x, double* y, int count) const
+{
+    evalIsa(isa, x, y, count);
+}
+
+double SimdEvaluator::maxDeviation (const double* x, int count) const
+{
+    std::vector<double> vector(count), scalar(count);
+    evalIsa(isa,    x, vector.data(), count);
+    evalIsa(Scalar, x, scalar.data(), count);
+
+    double deviation = 0.0;
+    for(int i = 0; i < count; i++)
+    {
+        const double a = vector[i];
+        const double b = scalar[i];
+        if(std::isnan(a) && std::isnan(b))
+            continue;
+        if(a == b) // also equal infinities
+            continue;
+
+        const double d = std::fabs(a - b) / std::fmax(1.0, std::fabs(b));
+        if(!(d <= deviation)) // NaN on one side only
+            deviation = d;
+    }
+    return deviation;
+}
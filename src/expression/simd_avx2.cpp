@@ -0,0 +1,81 @@
+// Compiled with AVX2 enabled (see premake5.lua), only called when cpuid reports AVX2
+
+#include "../include/expression/simd_kernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+/*
+ *
+ * AVX2 vector
+ *
+ */
+
+struct VecAVX2
+{
+    typedef __m256d type;
+    static constexpr int LANES = 4;
+
+    static type set1   (double v)            { return _mm256_set1_pd(v);     }
+    static type load   (const double* p)     { return _mm256_load_pd(p);     }
+    static type loadu  (const double* p)     { return _mm256_loadu_pd(p);    }
+    static void store  (double* p, type v)   { _mm256_store_pd(p, v);        }
+    static void storeu (double* p, type v)   { _mm256_storeu_pd(p, v);       }
+
+    static type add  (type a, type b) { return _mm256_add_pd(a, b); }
+    static type sub  (type a, type b) { return _mm256_sub_pd(a, b); }
+    static type mul  (type a, type b) { return _mm256_mul_pd(a, b); }
+    static type div  (type a, type b) { return _mm256_div_pd(a, b); }
+    static type min  (type a, type b) { return _mm256_min_pd(a, b); }
+    static type max  (type a, type b) { return _mm256_max_pd(a, b); }
+    static type sqrt (type a)         { return _mm256_sqrt_pd(a);   }
+
+    static type and_ (type a, type b) { return _mm256_and_pd(a, b); }
+    static type or_  (type a, type b) { return _mm256_or_pd(a, b);  }
+    static type xor_ (type a, type b) { return _mm256_xor_pd(a, b); }
+    static type neg  (type a)         { return _mm256_xor_pd(a, _mm256_set1_pd(-0.0));    }
+    static type abs  (type a)         { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+
+    static type lt  (type a, type b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ);  }
+    static type le  (type a, type b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ);  }
+    static type gt  (type a, type b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ);  }
+    static type ge  (type a, type b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ);  }
+    static type eq  (type a, type b) { return _mm256_cmp_pd(a, b, _CMP_EQ_OQ);  }
+    static type neq (type a, type b) { return _mm256_cmp_pd(a, b, _CMP_NEQ_UQ); }
+    static type nle (type a, type b) { return _mm256_cmp_pd(a, b, _CMP_NLE_UQ); }
+
+    // mask ? a : b
+    static type blend (type mask, type a, type b) { return _mm256_blendv_pd(b, a, mask); }
+    static bool any   (type mask)                 { return _mm256_movemask_pd(mask) != 0; }
+
+    static type floor (type a) { return _mm256_floor_pd(a); }
+
+    static type shl52 (type a) { return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a), 52)); }
+
+    // biased exponent of a positive a, as a double
+    static type exponent (type a)
+    {
+        const __m256i e = _mm256_srli_epi64(_mm256_castpd_si256(a), 52);
+        const type d = _mm256_castsi256_pd(_mm256_or_si256(e, _mm256_set1_epi64x(0x4330000000000000ll))); // 2^52 + e
+        return _mm256_sub_pd(d, _mm256_set1_pd(4503599627370496.0));
+    }
+
+    // mantissa of a, scaled to [0.5, 1)
+    static type mantissa (type a)
+    {
+        const type bits = _mm256_and_pd(a, _mm256_castsi256_pd(_mm256_set1_epi64x(0x000FFFFFFFFFFFFFll)));
+        return _mm256_or_pd(bits, _mm256_castsi256_pd(_mm256_set1_epi64x(0x3FE0000000000000ll)));
+    }
+};
+
+void simd_eval_avx2 (const Bytecode::Instruction* code, int size, const double* x, double* y, int count)
+{
+    SimdKernel<VecAVX2>::eval(code, size, x, y, count);
+}
+
+#else
+
+void simd_eval_avx2 (const Bytecode::Instruction*, int, const double*, double*, int) {}
+
+#endif
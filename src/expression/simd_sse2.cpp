@@ -0,0 +1,84 @@
+#include "../include/expression/simd_kernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <emmintrin.h>
+
+/*
+ *
+ * SSE2 vector
+ *
+ */
+
+struct VecSSE2
+{
+    typedef __m128d type;
+    static constexpr int LANES = 2;
+
+    static type set1   (double v)            { return _mm_set1_pd(v);     }
+    static type load   (const double* p)     { return _mm_load_pd(p);     }
+    static type loadu  (const double* p)     { return _mm_loadu_pd(p);    }
+    static void store  (double* p, type v)   { _mm_store_pd(p, v);        }
+    static void storeu (double* p, type v)   { _mm_storeu_pd(p, v);       }
+
+    static type add  (type a, type b) { return _mm_add_pd(a, b); }
+    static type sub  (type a, type b) { return _mm_sub_pd(a, b); }
+    static type mul  (type a, type b) { return _mm_mul_pd(a, b); }
+    static type div  (type a, type b) { return _mm_div_pd(a, b); }
+    static type min  (type a, type b) { return _mm_min_pd(a, b); }
+    static type max  (type a, type b) { return _mm_max_pd(a, b); }
+    static type sqrt (type a)         { return _mm_sqrt_pd(a);   }
+
+    static type and_ (type a, type b) { return _mm_and_pd(a, b); }
+    static type or_  (type a, type b) { return _mm_or_pd(a, b);  }
+    static type xor_ (type a, type b) { return _mm_xor_pd(a, b); }
+    static type neg  (type a)         { return _mm_xor_pd(a, _mm_set1_pd(-0.0));    }
+    static type abs  (type a)         { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+
+    static type lt  (type a, type b) { return _mm_cmplt_pd(a, b);  }
+    static type le  (type a, type b) { return _mm_cmple_pd(a, b);  }
+    static type gt  (type a, type b) { return _mm_cmpgt_pd(a, b);  }
+    static type ge  (type a, type b) { return _mm_cmpge_pd(a, b);  }
+    static type eq  (type a, type b) { return _mm_cmpeq_pd(a, b);  }
+    static type neq (type a, type b) { return _mm_cmpneq_pd(a, b); }
+    static type nle (type a, type b) { return _mm_cmpnle_pd(a, b); }
+
+    // mask ? a : b
+    static type blend (type mask, type a, type b) { return _mm_or_pd(_mm_and_pd(mask, a), _mm_andnot_pd(mask, b)); }
+    static bool any   (type mask)                 { return _mm_movemask_pd(mask) != 0; }
+
+    // |a| < 2^31
+    static type floor (type a)
+    {
+        const type t = _mm_cvtepi32_pd(_mm_cvttpd_epi32(a));
+        return _mm_sub_pd(t, _mm_and_pd(_mm_cmpgt_pd(t, a), _mm_set1_pd(1.0)));
+    }
+
+    static type shl52 (type a) { return _mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a), 52)); }
+
+    // biased exponent of a positive a, as a double
+    static type exponent (type a)
+    {
+        const __m128i e = _mm_srli_epi64(_mm_castpd_si128(a), 52);
+        const type d = _mm_castsi128_pd(_mm_or_si128(e, _mm_set1_epi64x(0x4330000000000000ll))); // 2^52 + e
+        return _mm_sub_pd(d, _mm_set1_pd(4503599627370496.0));
+    }
+
+    // mantissa of a, scaled to [0.5, 1)
+    static type mantissa (type a)
+    {
+        const type bits = _mm_and_pd(a, _mm_castsi128_pd(_mm_set1_epi64x(0x000FFFFFFFFFFFFFll)));
+        return _mm_or_pd(bits, _mm_castsi128_pd(_mm_set1_epi64x(0x3FE0000000000000ll)));
+    }
+};
+
+void simd_eval_sse2 (const Bytecode::Instruction* code, int size, const double* x, double* y, int count)
+{
+    SimdKernel<VecSSE2>::eval(code, size, x, y, count);
+}
+
+#else
+
+void simd_eval_sse2 (const Bytecode::Instruction*, int, const double*, double*, int) {}
+
+#endif
@@ -0,0 +1,184 @@
+#include "include/frameprofiler.hpp"
+#include "include/debug/ClassManager.hpp"
+#include <fstream>
+#include <string>
+
+/*
+ *
+ * FrameProfiler
+ *
+ */
+
+FrameProfiler::FrameProfiler ()
+{
+    timerQueries = GLAD_GL_VERSION_3_3 != 0;
+    if(timerQueries)
+        glGenQueries(FRAMES_IN_FLIGHT * STAGE_COUNT * 2, &queries[0][0][0]);
+}
+
+void FrameProfiler::destroy ()
+{
+    if(timerQueries)
+        glDeleteQueries(FRAMES_IN_FLIGHT * STAGE_COUNT * 2, &queries[0][0][0]);
+}
+
+void FrameProfiler::beginFrame ()
+{
+    current = (current + 1) % FRAMES_IN_FLIGHT;
+    collect(current);
+}
+
+void FrameProfiler::begin (Stage stage)
+{
+    if(current < 0)
+        return;
+
+    if(timerQueries)
+        glQueryCounter(queries[current][stage][0], GL_TIMESTAMP);
+    cpuBegin[stage] = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::end (Stage stage)
+{
+    if(current < 0)
+        return;
+
+    const std::chrono::duration<float, std::milli> cpu = std::chrono::steady_clock::now() - cpuBegin[stage];
+    cpuTimes[current][stage] = cpu.count();
+
+    if(timerQueries)
+        glQueryCounter(queries[current][stage][1], GL_TIMESTAMP);
+    issued[current][stage] = true;
+}
+
+// Folds the frame recorded FRAMES_IN_FLIGHT frames ago into the averages and the history
+void FrameProfiler::collect (int set)
+{
+    bool any = false;
+    Sample sample;
+    sample.frame = frames;
+
+    for(int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        sample.gpu[stage] = -1.0f;
+        sample.cpu[stage] = issued[set][stage] ? cpuTimes[set][stage] : 0.0f;
+        any = any || issued[set][stage];
+
+        if(!issued[set][stage] || !timerQueries)
+            continue;
+
+        // the end timestamp comes after the begin one, so both are available once it is
+        GLint available = 0;
+        glGetQueryObjectiv(queries[set][stage][1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(!available)
+            continue;
+
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(queries[set][stage][0], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(queries[set][stage][1], GL_QUERY_RESULT, &end);
+        sample.gpu[stage] = static_cast<float>(end - begin) * 1e-6f;
+    }
+
+    if(!any)
+        return;
+
+    const float weight = (frames == 0) ? 1.0f : SMOOTHING;
+    for(int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        if(sample.gpu[stage] >= 0.0f)
+            gpuAverage[stage] += (sample.gpu[stage] - gpuAverage[stage]) * weight;
+        cpuAverage[stage] += (sample.cpu[stage] - cpuAverage[stage]) * weight;
+        issued[set][stage] = false;
+    }
+
+    if(history.size() < HISTORY)
+        history.push_back(sample);
+    else
+        history[frames % HISTORY] = sample;
+    frames++;
+}
+
+bool FrameProfiler::save (const char* path) const
+{
+    std::ofstream file(path);
+    if(!file)
+        return false;
+
+    file << "frame";
+    for(int stage = 0; stage < STAGE_COUNT; stage++)
+    {
+        const std::string name = getStageName(static_cast<Stage>(stage));
+        file << ',' << name << "_gpu_ms," << name << "_cpu_ms";
+    }
+    file << '\n';
+
+    // oldest first
+    const long long first = frames - static_cast<long long>(history.size());
+    for(long long frame = first; frame < frames; frame++)
+    {
+        const Sample& sample = history[frame % HISTORY];
+        file << sample.frame;
+        for(int stage = 0; stage < STAGE_COUNT; stage++)
+        {
+            file << ',';
+            if(sample.gpu[stage] >= 0.0f)
+                file << sample.gpu[stage];
+            file << ',' << sample.cpu[stage];
+        }
+        file << '\n';
+    }
+
+    return static_cast<bool>(file);
+}
+
+const char* FrameProfiler::getStageName (Stage stage)
+{
+    switch(stage)
+    {
+    case Grid:      return "grid";
+    case Axes:      return "axes";
+    case Ticks:     return "ticks";
+    case Labels:    return "labels";
+    case Curves:    return "curves";
+    case Interface: return "imgui";
+    case DebugText: return "debug_text";
+    default:        return "unknown";
+    }
+}
+
+/*
+ *
+ * ClassManager
+ *
+ */
+
+void ClassManager::ImGui_printClassData (const char* nodelabel, const char* type, const FrameProfiler& profiler)
+{
+    static const ImVec4 color = {0.0f, 1.0f, 1.0f, 1.0f};
+
+    ImGui::PushID(&profiler);
+
+    if(ImGui_treeNode(nodelabel, type))
+    {
+        float gpuTotal = 0.0f;
+        float cpuTotal = 0.0f;
+        for(int stage = 0; stage < FrameProfiler::STAGE_COUNT; stage++)
+        {
+            const FrameProfiler::Stage s = static_cast<FrameProfiler::Stage>(stage);
+            gpuTotal += profiler.getGpuTime(s);
+            cpuTotal += profiler.getCpuTime(s);
+
+            std::string str_time = (profiler.hasTimerQueries() ? "GPU " + std::to_string(profiler.getGpuTime(s)) + " ms, " : "") +
+                                   "CPU " + std::to_string(profiler.getCpuTime(s)) + " ms";
+            ImGui_printLabel(color, FrameProfiler::getStageName(s), str_time.c_str());
+        }
+
+        std::string str_total = (profiler.hasTimerQueries() ? "GPU " + std::to_string(gpuTotal) + " ms, " : "") +
+                                "CPU " + std::to_string(cpuTotal) + " ms";
+        ImGui_printLabel(color, "total", str_total.c_str());
+        ImGui_printLabel(color, "frames", std::to_string(profiler.getFrames()).c_str());
+
+        ImGui::TreePop();
+    }
+    ImGui::PopID();
+}
@@ -0,0 +1,87 @@
+#include "include/glstate.hpp"
+
+/*
+ *
+ * GLState
+ *
+ */
+
+GLuint GLState::program     = GLState::UNKNOWN;
+GLuint GLState::vertexArray = GLState::UNKNOWN;
+GLuint GLState::arrayBuffer = GLState::UNKNOWN;
+GLuint GLState::activeUnit  = GLState::UNKNOWN;
+GLuint GLState::textures[MAX_TEXTURE_UNITS] = {};
+
+long long GLState::issued  = 0;
+long long GLState::skipped = 0;
+
+void GLState::useProgram (GLuint _program)
+{
+    if(program == _program) { skipped++; return; }
+
+    glUseProgram(_program);
+    program = _program;
+    issued++;
+}
+
+void GLState::bindVertexArray (GLuint VAO)
+{
+    if(vertexArray == VAO) { skipped++; return; }
+
+    glBindVertexArray(VAO);
+    vertexArray = VAO;
+    issued++;
+}
+
+void GLState::bindArrayBuffer (GLuint VBO)
+{
+    if(arrayBuffer == VBO) { skipped++; return; }
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    arrayBuffer = VBO;
+    issued++;
+}
+
+void GLState::bindTexture2D (GLuint unit, GLuint texture)
+{
+    if(activeUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+        issued++;
+    }
+
+    if(unit < MAX_TEXTURE_UNITS && textures[unit] == texture) { skipped++; return; }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    if(unit < MAX_TEXTURE_UNITS)
+        textures[unit] = texture;
+    issued++;
+}
+
+void GLState::releaseProgram (GLuint _program)
+{
+    if(program == _program)
+        program = UNKNOWN;
+}
+
+void GLState::releaseVertexArray (GLuint VAO)
+{
+    if(vertexArray == VAO)
+        vertexArray = UNKNOWN;
+}
+
+void GLState::releaseBuffer (GLuint buffer)
+{
+    if(arrayBuffer == buffer)
+        arrayBuffer = UNKNOWN;
+}
+
+void GLState::releaseTexture (GLuint texture)
+{
+    for(GLuint& bound : textures)
+    {
+        if(bound == texture)
+            bound = UNKNOWN;
+    }
+}
@@ -1,5 +1,6 @@
 #include "include/graph.hpp"
-#include <new>
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -7,6 +8,28 @@
 #include <iostream>
 #include <iomanip>
 
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+// Default colors of the curves, in the order the functions are given
+static const glm::vec3 curve_palette[] =
+{
+    {1.0f, 1.0f, 1.0f}, // white
+    {1.0f, 0.4f, 0.4f}, // red
+    {0.4f, 0.8f, 1.0f}, // blue
+    {1.0f, 0.9f, 0.3f}, // yellow
+    {0.5f, 1.0f, 0.5f}, // green
+    {0.9f, 0.5f, 1.0f}, // purple
+    {1.0f, 0.6f, 0.2f}, // orange
+    {0.3f, 1.0f, 0.9f}  // cyan
+};
+
+// World units per font pixel of the tick labels
+static const float label_scale = 0.05f;
+
 /*
  *
  * Graph
@@ -19,6 +42,8 @@ Graph::Graph
     Shader& _shader,
     Shader& _graphShader,
     Shader& _glyphShader,
+    Shader& _tickShader,
+    Shader& _gridShader,
     const Camera& _camera,
     float posX, float posY,
     float szX, float szY,
@@ -26,6 +51,18 @@ Graph::Graph
 )
     : graphShader(_graphShader),
       glyphShader(_glyphShader),
+      tickShader(_tickShader),
+      gridShader(_gridShader),
+      curveCountUniform(_graphShader.getUniform("curveCount")),
+      curveFirstUniform(_graphShader.getUniform("curveFirst")),
+      curveColorUniform(_graphShader.getUniform("curveColor")),
+      shiftUniform(_graphShader.getUniform("shift")),
+      glyphModelUniform(_glyphShader.getUniform("model")),
+      translationUniform(_tickShader.getUniform("translation")),
+      gridRatioUniform(_gridShader.getUniform("ratio")),
+      gridCenterUniform(_gridShader.getUniform("center")),
+      gridSpacingUniform(_gridShader.getUniform("spacing")),
+      gridFadeUniform(_gridShader.getUniform("fade")),
       step(_step),
       axisX (
           _shader, _camera,
@@ -47,14 +84,70 @@ Graph::Graph
     initializeAxes();
     generateLineContainers();
 
-    parser.DefineVar("x", &X);
-    parser.SetExpr("x^2");
+    ticks.gen_VAO();
+    ticks.gen_VBO();
+
+    labels.gen_VAO();
+    labels.gen_VBO();
+
+    gridContainer.gen_VAO();
+
+    viewRing.gen_VAO();
+    viewRing.gen_VBO();
+
+    curveStream.create();
+    uniformStream.create();
+
+    colors.assign(1, curve_palette[0]);
 
     updateRange(_range);
     getContainer()->update_VAO();
     updateVertices();
 }
 
+// Throws mu::Parser::exception_type and keeps the previous functions if any new one is invalid,
+// the curves already shown keep their colors
+void Graph::setFunctions (const std::vector<std::string>& funcs)
+{
+    if(funcs.size() > MAX_CURVES)
+        throw mu::Parser::exception_type("too many functions, at most " + std::to_string(MAX_CURVES));
+
+    switch(sampling)
+    {
+    case Implicit:   implicit.setFunctions(funcs);   break;
+    case Parametric: parametric.setFunctions(funcs); break;
+    case Polar:      polar.setFunctions(funcs);      break;
+    default:         sampler.setFunctions(funcs);    break;
+    }
+
+    const size_t palette = sizeof(curve_palette) / sizeof(curve_palette[0]);
+    for(size_t i = colors.size(); i < funcs.size(); i++)
+        colors.push_back(curve_palette[i % palette]);
+}
+
+// The other modes validate their functions in setFunctions()
+void Graph::testFunction ()
+{
+    if(sampling == Uniform || sampling == Adaptive || sampling == Viewport)
+        sampler.testFunction();
+}
+
+const std::vector<std::string>& Graph::getFunctions () const
+{
+    switch(sampling)
+    {
+    case Implicit:   return implicit.getFunctions();
+    case Parametric: return parametric.getFunctions();
+    case Polar:      return polar.getFunctions();
+    default:         return sampler.getFunctions();
+    }
+}
+
+int Graph::getFunctionCount () const
+{
+    return static_cast<int>(getFunctions().size());
+}
+
 void Graph::setAxisSize (float szX, float szY)
 {
     size = {szX, szY};
@@ -109,71 +202,371 @@ void Graph::generateLineContainers ()
     lineY.update_VAO();
 }
 
-void Graph::updateLineBuffer ()
+// One instance per tick, the X axis ticks at even instances and the Y axis ones at odd instances,
+// so that renderLines() draws all of them with a single call
+void Graph::updateLines ()
 {
-    ::operator delete(lines);
-    lines = reinterpret_cast<Object*>(::operator new(sizeof(Object) * lineCount));
-    lineBuffSize = lineCount;
+    if(ticks.getVerticesCount() != lineCount * 4)
+        ticks.new_vertices(lineCount * 4); /* offset.xy, scale.xy attributes */
 
+    GLfloat* tick = ticks.getVertices();
     for(int i = 0; i < lineCount; i += 2)
     {
-        new(lines + i) Object
+        int rng = i / 2 - range;
+        if(rng >= 0) rng++;
+
+        // vertical tick on the X axis
+        *tick++ = rng / (float)range * size.x;
+        *tick++ = -1.0f;
+        *tick++ =  0.0f;
+        *tick++ =  2.0f;
+
+        // horizontal tick on the Y axis
+        *tick++ = -1.0f;
+        *tick++ = rng / (float)range * size.y;
+        *tick++ =  2.0f;
+        *tick++ =  0.0f;
+    }
+
+    ticks.bind_VAO();
+    ticks.update_VBO();
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    labelsOutdated = true;
+}
+
+// The labels only change with the range, the axis size or the font, not with the camera
+void Graph::updateLabels (const TextRenderer& textRenderer, GLuint fontID)
+{
+    labelVertices.clear();
+    for(int i = 0; i < lineCount; i += 2)
+    {
+        int stepIdx = i / 2 - range;
+        if(stepIdx >= 0) stepIdx++;
+
+        const float offset = stepIdx / (float)range;
+
+        std::string num = std::to_string(stepIdx);
+        glm::vec2 text_size = textRenderer.fontTextSize(fontID, num, 0.5f, 0.5f);
+        textRenderer.layout(fontID, num, offset * size.x - text_size.x * label_scale, -2.0f, label_scale, -label_scale, labelVertices);
+
+        num = std::to_string(-stepIdx);
+        text_size = textRenderer.fontTextSize(fontID, num, 0.5f, 0.5f);
+        textRenderer.layout(fontID, num, 2.0f, offset * size.y + text_size.y / 2.0f * label_scale, label_scale, -label_scale, labelVertices);
+    }
+
+    const GLsizei count = static_cast<GLsizei>(labelVertices.size());
+    if(labels.getVerticesCount() != count)
+        labels.new_vertices(count);
+    std::copy(labelVertices.begin(), labelVertices.end(), labels.getVertices());
+
+    labels.bind_VAO();
+    labels.update_VBO();
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)0); /* pos.xy, tex.xy attributes */
+    glEnableVertexAttribArray(0);
+
+    labelsOutdated = false;
+    labelFont = fontID;
+}
+
+void Graph::updateVertices ()
+{
+    float xRatio =  (size.x / (float)range);
+    float yRatio = -(size.y / (float)range);
+
+    const glm::dvec2 origin = vertexOrigin();
+    sampledOrigin = origin;
+
+    if(sampling == Viewport)
+    {
+        long long first;
+        GLsizei count;
+        viewWindow(first, count, viewStep);
+
+        if(count == 0)
+        {
+            viewRing.setWindow(first, 0);
+            return;
+        }
+
+        // keep the buffers unless they are too small, far too large or hold another number of curves
+        if(count > viewRing.getCapacity() || count * 2 < viewRing.getCapacity() || viewRing.getCurves() != sampler.getFunctionCount())
+            viewRing.reset(count + count / 4, sampler.getFunctionCount()); // some slack for the window size changing while panning
+
+        viewRing.setWindow(first, count);
+        writeView(first, count);
+        return;
+    }
+
+    if(sampling == Implicit)
+    {
+        double left, right, bottom, top;
+        viewSpan(left, right);
+        viewBand(bottom, top);
+        const double marginX = (right - left) * VIEW_MARGIN;
+        const double marginY = (top - bottom) * VIEW_MARGIN;
+        sampledLeft   = left - marginX;
+        sampledRight  = right + marginX;
+        sampledBottom = bottom - marginY;
+        sampledTop    = top + marginY;
+
+        implicitStep = cellStep();
+        if(!std::isfinite(implicitStep) || implicitStep <= 0.0) // the camera is zoomed out to nothing
+            return;
+
+        implicit.sample
         (
-            shader, camera,
-            0, 0,
-            0, 0,
-            &lineY
+            sampledLeft, sampledRight,
+            sampledBottom, sampledTop,
+            implicitStep,
+            origin.x, origin.y,
+            xRatio, yRatio
         );
-        new(lines + i + 1) Object
+
+        const std::vector<float>& vertices = implicit.getVertices();
+        std::copy(vertices.begin(), vertices.end(), curveStream.map(static_cast<GLsizei>(vertices.size())));
+        curveStream.commit();
+        return;
+    }
+
+    if(sampling == Parametric || sampling == Polar)
+    {
+        CurveSampler& curves = (sampling == Polar) ? polar : parametric;
+        sampledZoom = camera.getZoom();
+        curves.sample(origin.x, origin.y, xRatio, yRatio, sampledZoom);
+
+        const std::vector<float>& vertices = curves.getVertices();
+        std::copy(vertices.begin(), vertices.end(), curveStream.map(static_cast<GLsizei>(vertices.size())));
+        curveStream.commit();
+        return;
+    }
+
+    if(sampling == Adaptive)
+    {
+        double bottom, top;
+        viewBand(bottom, top);
+        const double margin = (top - bottom) * VIEW_MARGIN;
+        sampledBottom = bottom - margin;
+        sampledTop    = top + margin;
+
+        sampledZoom = camera.getZoom();
+        adaptive.sample
         (
-            shader, camera,
-            0, 0,
-            0, 0,
-            &lineX
+            sampler,
+            -range, range,
+            sampledBottom, sampledTop,
+            origin.x, origin.y,
+            xRatio, yRatio,
+            sampledZoom
         );
+
+        const std::vector<float>& vertices = adaptive.getVertices();
+        std::copy(vertices.begin(), vertices.end(), curveStream.map(static_cast<GLsizei>(vertices.size())));
+        curveStream.commit();
+        return;
     }
+
+    // Uniform samples are evaluated in the background, see pollVertices()
+    AsyncSampler::Request request;
+    request.functions = sampler.getFunctions();
+    request.engine   = sampler.getEngine();
+    request.isa      = sampler.getSimd().getIsa();
+    request.derivative = sampler.getDerivative();
+    request.count    = pointsCount;
+    request.start    = -range;
+    request.step     = step;
+    request.originX  = origin.x;
+    request.originY  = origin.y;
+    request.ratioX   = xRatio;
+    request.ratioY   = yRatio;
+    background.submit(request);
 }
 
-void Graph::updateLines () // to be optimized
+// Swaps in the vertices of a finished background job, the previous ones are drawn until then
+bool Graph::pollVertices ()
 {
-    float rng = -range;
-    for(int i = 0; i < lineCount; i += 2)
+    AsyncSampler::Result result;
+    if(!background.poll(result))
+        return false;
+
+    samplingError = result.error;
+    if(result.error.empty())
     {
-        if(rng == 0)
-            rng++;
+        // written into a region that is not being drawn
+        const GLsizei new_verticesCount = result.count * result.curves * 2; /* x,y attributes */
+        std::copy(result.vertices.begin(), result.vertices.begin() + new_verticesCount, uniformStream.map(new_verticesCount));
+        uniformStream.commit();
+
+        uniformPointsCount = result.count;
+        uniformCurves = result.curves;
+        uniformOrigin = {result.originX, result.originY};
+    }
 
-        lines[i].size = {10.0f, 1.0f};
-        lines[i].position.x = position.x + (rng / range * size.y) - lines[i].size.x / 2.0f;
-        lines[i].position.y = position.y;
-        lines[i].updateModel();
+    background.recycle(result);
+    return true;
+}
 
-        lines[i+1].size = {1.0f, 10.0f};
-        lines[i+1].position.x = position.x;
-        lines[i+1].position.y = position.y + (rng / range * size.y) - lines[i+1].size.y / 2.0f;
-        lines[i+1].updateModel();
+void Graph::updateView ()
+{
+    if(sampling != Viewport)
+    {
+        updateVertices();
+        return;
+    }
+
+    long long first;
+    GLsizei count;
+    double _step;
+    viewWindow(first, count, _step);
 
-        rng++;
+    const long long last    = first + count;
+    const long long oldFirst = viewRing.getFirst();
+    const long long oldLast  = oldFirst + viewRing.getCount();
+
+    // a re-based camera origin moves every vertex, the whole window is rewritten against the new one
+    if(_step != viewStep || count > viewRing.getCapacity() || last <= oldFirst || first >= oldLast ||
+       viewRing.getCurves() != sampler.getFunctionCount() || vertexOrigin() != sampledOrigin)
+    {
+        updateVertices();
+        return;
     }
+
+    viewRing.setWindow(first, count);
+    if(first < oldFirst) writeView(first, static_cast<GLsizei>(oldFirst - first));
+    if(last  > oldLast)  writeView(oldLast, static_cast<GLsizei>(last - oldLast));
 }
 
-void Graph::updateVertices ()
+// Samples of the visible part of the X axis, widened by VIEW_MARGIN on both sides,
+// with the power of two step giving one to two samples per pixel column
+void Graph::viewWindow (long long& first, GLsizei& count, double& _step) const
 {
-    Container* container = getContainer();
-    GLfloat* const vertices = container->getVertices();
-    GLsizei verticesCount = container->getVerticesCount();
+    const double xRatio = size.x / (double)range;
+    const double pixelsPerUnit = xRatio * camera.getZoom();
 
-    float xRatio =  (size.x / (float)range);
-    float yRatio = -(size.y / (float)range);
+    _step = std::exp2(std::floor(std::log2(1.0 / pixelsPerUnit)));
+    if(!std::isfinite(_step) || _step <= 0.0) // the camera is zoomed out to nothing
+    {
+        first = 0;
+        count = 0;
+        return;
+    }
 
-    X = -range;
-    for(int i = 0; i < verticesCount;)
+    double left, right;
+    viewSpan(left, right);
+    const double margin = (right - left) * VIEW_MARGIN;
+
+    first = static_cast<long long>(std::floor((left - margin) / _step));
+    count = static_cast<GLsizei>(std::ceil((right + margin) / _step) - first) + 1;
+}
+
+// Visible part of the X axis
+void Graph::viewSpan (double& left, double& right) const
+{
+    const double xRatio = size.x / (double)range;
+
+    left  = (camera.getViewMin().x - position.x) / xRatio;
+    right = (camera.getViewMax().x - position.x) / xRatio;
+}
+
+// Power of two width giving cells of CELL_PIXELS / 2 to CELL_PIXELS pixels on screen
+double Graph::cellStep () const
+{
+    const double pixelsPerUnit = size.x / (double)range * camera.getZoom();
+    return std::exp2(std::floor(std::log2(ImplicitSampler::CELL_PIXELS / pixelsPerUnit)));
+}
+
+// Visible range of f, the Y axis points up on screen while world Y grows downwards
+void Graph::viewBand (double& bottom, double& top) const
+{
+    const double yRatio = -(size.y / (double)range);
+
+    bottom = (camera.getViewMax().y - position.y) / yRatio;
+    top    = (camera.getViewMin().y - position.y) / yRatio;
+}
+
+// Writes the samples [first, first + count) of every curve into the ring, from the tile cache
+void Graph::writeView (long long first, GLsizei count)
+{
+    const float xRatio =  (size.x / (float)range);
+    const float yRatio = -(size.y / (float)range);
+
+    viewValues.resize(count);
+    for(int curve = 0; curve < viewRing.getCurves(); curve++)
+    {
+        tileCache.fetch(sampler, curve, std::ilogb(viewStep), first, count, viewValues.data());
+
+        viewRing.write(curve, first, count, [&](long long index, GLfloat* vertices, GLsizei length)
+        {
+            const double* y = viewValues.data() + (index - first);
+            for(GLsizei i = 0; i < length; i++)
+            {
+                *vertices++ = sampledOrigin.x + (index + i) * viewStep * xRatio;
+                *vertices++ = sampledOrigin.y + y[i] * yRatio;
+            }
+        });
+    }
+}
+
+glm::dvec2 Graph::vertexOrigin () const
+{
+    return glm::dvec2(position) - camera.getOrigin();
+}
+
+// curveFirst must be ascending, the vertex shader looks the curve of every vertex up in it
+void Graph::useCurves (const std::vector<GLint>& curveFirst)
+{
+    const GLsizei curves = static_cast<GLsizei>(std::min<size_t>(curveFirst.size(), colors.size()));
+
+    graphShader.use();
+    graphShader.setUniform(curveCountUniform, static_cast<GLint>(curves));
+    if(curves == 0)
+        return;
+
+    graphShader.setUniform1v(curveFirstUniform, curves, curveFirst.data());
+    graphShader.setUniform3v(curveColorUniform, curves, &colors[0].x);
+}
+
+bool Graph::isSamplingOutdated () const
+{
+    if(vertexOrigin() != sampledOrigin) // the camera re-based its origin
+        return true;
+
+    switch(sampling)
     {
-        vertices[i++] = position.x + X             * xRatio;
-        vertices[i++] = position.y + parser.Eval() * yRatio;
-        X += step;
+    case Adaptive:
+    {
+        double bottom, top;
+        viewBand(bottom, top);
+        return camera.getZoom() != sampledZoom || bottom < sampledBottom || top > sampledTop;
+    }
+
+    case Viewport:
+    {
+        long long first;
+        GLsizei count;
+        double _step;
+        viewWindow(first, count, _step);
+
+        return _step != viewStep || first != viewRing.getFirst() || count != viewRing.getCount();
     }
 
-    container->update_VBO();
+    case Implicit:
+    {
+        double left, right, bottom, top;
+        viewSpan(left, right);
+        viewBand(bottom, top);
+        return cellStep() != implicitStep || left < sampledLeft || right > sampledRight || bottom < sampledBottom || top > sampledTop;
+    }
+
+    case Parametric:
+    case Polar:
+        return camera.getZoom() != sampledZoom;
+
+    default:
+        return false;
+    }
 }
 
 void Graph::updateRange (int _range)
@@ -181,70 +574,162 @@ void Graph::updateRange (int _range)
     range = _range;
 
     lineCount = range * 2 * 2;
-    if(lineCount > lineBuffSize)
-        updateLineBuffer();
 
     pointsCount = 1 + (range * 2) / step;
-    const int new_verticesCount = pointsCount * 2; /* x,y attributes */
-
-    Container* container = getContainer();
-    if(new_verticesCount > container->getVBOSize())
-        container->new_vertices(new_verticesCount);
 
     updateLines();
 }
 
-void Graph::updateGlyphModel (float posX, float posY)
+// The tick lines first and their labels after, so that both stages can be timed
+void Graph::renderLines(const TextRenderer& textRenderer, GLuint fontID, float colorR, float colorG, float colorB, float alpha)
 {
+    if(profiler) profiler->begin(FrameProfiler::Ticks);
+    const glm::dvec2 translation = vertexOrigin();
+    tickShader.use();
+    tickShader.setUniform(translationUniform, static_cast<GLfloat>(translation.x), static_cast<GLfloat>(translation.y));
+    ticks.bind_VAO();
+    glDrawArraysInstanced(GL_LINES, 0, 2, lineCount);
+    if(profiler) profiler->end(FrameProfiler::Ticks);
+
+    // the cached label mesh is moved with the graph by its model matrix
+    if(profiler) profiler->begin(FrameProfiler::Labels);
+    if(labelsOutdated || fontID != labelFont)
+        updateLabels(textRenderer, fontID);
+
+    const glm::mat4 model = glm::translate(glm::mat4(1.0f), {static_cast<float>(translation.x), static_cast<float>(translation.y), 0.0f});
     glyphShader.use();
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, {posX, posY, 0.0f});
-    model = glm::scale(model, {0.05f, -0.05f, 0.0f});
-    glyphShader.setUniformMatrix4("model", 1, GL_FALSE, glm::value_ptr(model));
+    glyphShader.setUniformMatrix4(glyphModelUniform, 1, GL_FALSE, glm::value_ptr(model));
+    textRenderer.render(fontID, labels, colorR, colorG, colorB, alpha);
+    if(profiler) profiler->end(FrameProfiler::Labels);
 }
 
-void Graph::renderLines(const TextRenderer& textRenderer, GLuint fontID, float colorR, float colorG, float colorB, float alpha)
+// The spacing is worked out per axis, in double, along with the view center
+// taken modulo the widest spacing so that the shader works with small numbers
+void Graph::renderGrid ()
 {
-    for(int i = 0; i < lineCount; i += 2)
-    {
-        const Object& _lineX = lines[i];
-        const Object& _lineY = lines[i+1];
-        _lineX.drawArrays(GL_LINES, 2);
-        _lineY.drawArrays(GL_LINES, 2);
+    if(profiler) profiler->begin(FrameProfiler::Grid);
 
-        // text rendering (very inefficient)
+    const glm::dvec2 ratio = {size.x / (double)range, -size.y / (double)range}; // as the vertices are written
+    const glm::dvec2 center = camera.getOrigin() + glm::dvec2(camera.getResidual());
+    const glm::dvec2 graphCenter = (center - glm::dvec2(position)) / ratio;
 
-        int stepIdx = i / 2 - range; // to be optimized
-        if(stepIdx >= 0) stepIdx++;
+    glm::vec2 spacing, fade, gridCenter;
+    for(int axis = 0; axis < 2; axis++)
+    {
+        const double level = std::log10(GRID_MIN_PIXELS / (camera.getZoom() * std::fabs(ratio[axis])));
+        const double power = std::ceil(level);
+        const double minor = std::pow(10.0, power);
+        const double widest = minor * 100.0;
 
-        std::string num = std::to_string(stepIdx);
-        updateGlyphModel(_lineX.position.x + _lineX.size.x / 2.0f, _lineX.position.y - _lineX.size.y * 2.0f);
-        glm::vec2 text_size = textRenderer.fontTextSize(fontID, num, 0.5f, 0.5f);
-        textRenderer.render(fontID, num, -text_size.x, 0.0f, 1.0f, 1.0f, colorR, colorG, colorB, alpha);
+        double c = std::fmod(graphCenter[axis], widest);
+        if(c < 0.0) c += widest;
 
-        num = std::to_string(-stepIdx);
-        updateGlyphModel(_lineY.position.x + _lineY.size.x * 2.0f, _lineY.position.y + _lineY.size.y / 2.0f);
-        text_size = textRenderer.fontTextSize(fontID, num, 0.5f, 0.5f);
-        textRenderer.render(fontID, num, 0.0f, -text_size.y / 2.0f, 1.0f, 1.0f, colorR, colorG, colorB, alpha);
+        spacing[axis]    = static_cast<float>(minor);
+        fade[axis]       = static_cast<float>(power - level);
+        gridCenter[axis] = static_cast<float>(c);
     }
+
+    gridShader.use();
+    gridShader.setUniform(gridRatioUniform, static_cast<GLfloat>(ratio.x), static_cast<GLfloat>(ratio.y));
+    gridShader.setUniform(gridCenterUniform, gridCenter.x, gridCenter.y);
+    gridShader.setUniform(gridSpacingUniform, spacing.x, spacing.y);
+    gridShader.setUniform(gridFadeUniform, fade.x, fade.y);
+    gridContainer.bind_VAO();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    if(profiler) profiler->end(FrameProfiler::Grid);
 }
 
 void Graph::render (const TextRenderer& textRenderer, GLuint fontID, float colorR, float colorG, float colorB, float alpha)
 {
+    if(grid)
+        renderGrid();
+
+    if(profiler) profiler->begin(FrameProfiler::Axes);
     axisX.drawArrays(GL_LINES, 2);
     axisY.drawArrays(GL_LINES, 2);
+    if(profiler) profiler->end(FrameProfiler::Axes);
 
     renderLines(textRenderer, fontID, colorR, colorG, colorB, alpha);
 
+    if(profiler) profiler->begin(FrameProfiler::Curves);
+
+    // vertices written before the camera re-based its origin are moved onto the new one until replaced
+    const glm::dvec2 shift = ((sampling == Uniform) ? uniformOrigin : sampledOrigin) - vertexOrigin();
     graphShader.use();
-    getContainer()->bind_VAO();
-    glDrawArrays(GL_LINE_STRIP, 0, pointsCount);
+    graphShader.setUniform(shiftUniform, static_cast<GLfloat>(shift.x), static_cast<GLfloat>(shift.y));
+
+    // every curve is drawn by the same call, the shader picks its color from the vertex index
+    std::vector<GLint> curveFirst;
+    switch(sampling)
+    {
+    case Adaptive:
+        curveFirst = adaptive.getCurveFirst();
+        useCurves(curveFirst);
+        curveStream.bind_VAO();
+        glMultiDrawArrays(GL_LINE_STRIP, adaptive.getStripFirst().data(), adaptive.getStripCount().data(), adaptive.getStripsCount());
+        curveStream.fence();
+        break;
+    case Implicit:
+        curveFirst = implicit.getCurveFirst();
+        useCurves(curveFirst);
+        curveStream.bind_VAO();
+        glDrawArrays(GL_LINES, 0, implicit.getPointsCount());
+        curveStream.fence();
+        break;
+    case Parametric:
+    case Polar:
+    {
+        const CurveSampler& curves = getCurveSampler();
+        curveFirst = curves.getCurveFirst();
+        useCurves(curveFirst);
+        curveStream.bind_VAO();
+        glMultiDrawArrays(GL_LINE_STRIP, curves.getStripFirst().data(), curves.getStripCount().data(), curves.getStripsCount());
+        curveStream.fence();
+        break;
+    }
+    case Viewport:
+        for(int curve = 0; curve < viewRing.getCurves(); curve++)
+            curveFirst.push_back(viewRing.getCurveFirst(curve));
+        useCurves(curveFirst);
+        viewRing.draw(GL_LINE_STRIP);
+        break;
+    default:
+    {
+        std::vector<GLsizei> curveCount(uniformCurves, uniformPointsCount);
+        for(int curve = 0; curve < uniformCurves; curve++)
+            curveFirst.push_back(curve * uniformPointsCount);
+        useCurves(curveFirst);
+        uniformStream.bind_VAO();
+        glMultiDrawArrays(GL_LINE_STRIP, curveFirst.data(), curveCount.data(), uniformCurves);
+        uniformStream.fence();
+        break;
+    }
+    }
+
+    if(profiler) profiler->end(FrameProfiler::Curves);
 }
 
 void Graph::destroy ()
 {
     Object::destroy();
-    ::operator delete(lines);
+
+    viewRing.del_VAO();
+    viewRing.del_VBO();
+    delete[] viewRing.getVertices();
+
+    curveStream.destroy();
+    uniformStream.destroy();
+
+    ticks.del_VAO();
+    ticks.del_VBO();
+    delete[] ticks.getVertices();
+
+    labels.del_VAO();
+    labels.del_VBO();
+    delete[] labels.getVertices();
+
+    gridContainer.del_VAO();
 }
 
 /*
@@ -265,47 +750,137 @@ void ClassManager::ImGui_printClassData (const char* nodelabel, const char* type
         int range               = graph.getRange();
         int lineCount           = graph.getLineCount();
         int pointsCount         = graph.getPointsCount();
-        GLsizei lineBuffSize    = graph.getLineBuffSize();
         const Container& lineX  = graph.getLineX();
         const Container& lineY  = graph.getLineY();
         const Object& axisX     = graph.getAxisX();
         const Object& axisY     = graph.getAxisY();
-        const Object* lines     = graph.getLines();
+        const Container& ticks  = graph.getTicks();
+        const Sampler& sampler  = graph.getSampler();
 
         std::string str_Xstep   = std::to_string(step);
         std::string str_range   = std::to_string(range);
-        std::string str_steps   = std::to_string(lineCount) + " [MAX " + std::to_string(lineBuffSize) + "]";
+        std::string str_steps   = std::to_string(lineCount) + " [MAX " + std::to_string(ticks.getVBOSize() / 4) + "]";
         std::string str_fpoints = std::to_string(pointsCount);
+        std::string str_sampling = "Uniform";
+        std::string str_tiles;
+        if(graph.getSampling() == Graph::Adaptive)
+        {
+            const AdaptiveSampler& adaptive = graph.getAdaptiveSampler();
+            str_fpoints  = std::to_string(adaptive.getPointsCount());
+            str_sampling = "Adaptive (" + std::to_string(adaptive.getStripsCount()) + " strips, " +
+                           std::to_string(adaptive.getPasses()) + " passes, " +
+                           std::to_string(adaptive.getCulled()) + " culled, " +
+                           (adaptive.hasTangents() ? std::to_string(adaptive.getTangentSplits()) + " split by tangents, " : "") +
+                           "tolerance " + std::to_string(adaptive.getTolerance()) + " px)";
+        }
+        else if(graph.getSampling() == Graph::Implicit)
+        {
+            const ImplicitSampler& implicit = graph.getImplicitSampler();
+            str_fpoints  = std::to_string(implicit.getEvaluated());
+            str_sampling = "Implicit (" + std::to_string(implicit.getPointsCount() / 2) + " segments, cell 2^" +
+                           std::to_string(std::lround(std::log2(graph.getImplicitStep()))) + ", " +
+                           std::to_string(implicit.getTileCount()) + " tiles, " +
+                           std::to_string(implicit.getCulled()) + " blocks culled" +
+                           (implicit.hasInterval() ? ")" : ", no interval form)");
+        }
+        else if(graph.getSampling() == Graph::Parametric || graph.getSampling() == Graph::Polar)
+        {
+            const CurveSampler& curves = graph.getCurveSampler();
+            str_fpoints  = std::to_string(curves.getPointsCount());
+            str_sampling = std::string(graph.getSampling() == Graph::Polar ? "Polar" : "Parametric") +
+                           " (" + std::to_string(curves.getStripsCount()) + " strips, t in [" +
+                           std::to_string(curves.getRangeMin()) + ", " + std::to_string(curves.getRangeMax()) + "], spacing " +
+                           std::to_string(curves.getSpacing()) + " px)";
+        }
+        else if(graph.getSampling() == Graph::Viewport)
+        {
+            const double viewEnd = graph.getViewStart() + (graph.getViewPointsCount() - 1) * graph.getViewStep();
+            str_fpoints  = std::to_string(graph.getViewPointsCount());
+            str_sampling = "Viewport (step 2^" + std::to_string(std::lround(std::log2(graph.getViewStep()))) + ", [" +
+                           std::to_string(graph.getViewStart()) + ", " + std::to_string(viewEnd) + "])";
+
+            const TileCache& tiles = graph.getTileCache();
+            str_tiles = std::to_string(tiles.getTileCount()) + " (" + std::to_string(tiles.getMemory() >> 10) + " / " +
+                        std::to_string(tiles.getBudget() >> 10) + " KiB), " + std::to_string(tiles.getHits()) + " hits, " +
+                        std::to_string(tiles.getMisses()) + " misses";
+        }
+        std::string str_bytecode;
+        if(!sampler.getBytecode().empty())
+        {
+            const Optimizer& optimizer = sampler.getOptimizer();
+            str_bytecode = std::to_string(optimizer.getInstructionsBefore()) + " -> " +
+                           std::to_string(optimizer.getInstructionsAfter()) + " instructions (" +
+                           std::to_string(optimizer.getFolded()) + " folded, " +
+                           std::to_string(optimizer.getShared()) + " shared, " +
+                           std::to_string(optimizer.getHoisted()) + " hoisted)";
+        }
+        static const char* derivatives[] = {"f", "f'", "f''"};
+        std::string str_derivative = std::string(derivatives[sampler.getDerivative()]) +
+                                     (sampler.getDual().isLoaded() ? " (dual form)" : " (no dual form)");
+        std::string str_background = graph.isSamplingBusy() ? "busy (" + std::to_string(static_cast<int>(graph.getSamplingProgress() * 100.0f)) + "%)" : "idle";
+        std::string str_threads = std::to_string(sampler.getThreadCount());
+        const std::vector<std::string>& functions = graph.getFunctions();
+        std::string str_func;
+        for(size_t i = 0; i < functions.size(); i++)
+            str_func += (i ? ", \"" : "\"") + functions[i] + "\"";
+        if(functions.size() > 1)
+            str_func += " (" + std::to_string(functions.size()) + " curves)";
+        std::string str_engine  = Sampler::getEngineName(sampler.getActiveEngine());
+        if(sampler.getActiveEngine() == Sampler::Jit)
+            str_engine += " (" + std::to_string(sampler.getJit().getCodeSize()) + " bytes)";
+        else if(sampler.getActiveEngine() == Sampler::Simd)
+        {
+            // compare the vector kernels against the scalar reference over the visible range
+            double probe[256];
+            for(int i = 0; i < 256; i++)
+                probe[i] = -range + i * (2.0 * range / 255.0);
+
+            const SimdEvaluator& simd = sampler.getSimd();
+            str_engine += " (" + std::string(SimdEvaluator::getIsaName(simd.getIsa())) +
+                          ", max deviation " + std::to_string(simd.maxDeviation(probe, 256)) + ")";
+        }
+        else if(sampler.getEngine() != sampler.getActiveEngine())
+        {
+            const std::string& reason = sampler.getBytecode().empty()        ? sampler.getBytecode().getError() :
+                                        (sampler.getEngine() == Sampler::Jit) ? sampler.getJit().getError()
+                                                                              : sampler.getSimd().getError();
+            str_engine += " [" + std::string(Sampler::getEngineName(sampler.getEngine())) + " unavailable: " + reason + "]";
+        }
 
         const Object& object = dynamic_cast<const Object&>(graph);
         ImGui_printClassData(object);
 
         ImGui_printClassData("lineX", &lineX);
         ImGui_printClassData("lineY", &lineY);
+        ImGui_printClassData("viewRing", &graph.getViewRing());
+        ImGui_printClassData("curveStream", &graph.getCurveStream());
+        ImGui_printClassData("uniformStream", &graph.getUniformStream());
 
         ImGui_printClassData("axisX", axisX);
         ImGui_printClassData("axisY", axisY);
 
-        ImGui::PushID(lines);
-        if(ImGui_treeNode("lines", "Object*  "))
-        {
-            for(int i = 0; i < lineCount; i++)
-            {
-                ImGui::PushID(i);
-                ImGui_printClassData(lines[i]);
-                ImGui::PopID();
-            }
-            ImGui::TreePop();
-        }
-        ImGui::PopID();
+        ImGui_printClassData("ticks", &ticks);
+        ImGui_printClassData("labels", &graph.getLabels());
 
         ImGui_printClassData("Graph Shader", graph.getGraphShader());
         ImGui_printClassData("Glyph Shader", graph.getGlyphShader());
+        ImGui_printClassData("Tick Shader",  graph.getTickShader());
+        ImGui_printClassData("Grid Shader",  graph.getGridShader());
 
         ImGui_printLabel(color, "X-step", str_Xstep.c_str());
         ImGui_printLabel(color, "range",  str_range.c_str());
         ImGui_printLabel(color, "steps",  str_steps.c_str());
         ImGui_printLabel(color, "points", str_fpoints.c_str());
+        ImGui_printLabel(color, "sampling", str_sampling.c_str());
+        if(!str_tiles.empty())
+            ImGui_printLabel(color, "tiles", str_tiles.c_str());
+        ImGui_printLabel(color, "function", str_func.c_str());
+        ImGui_printLabel(color, "plot", str_derivative.c_str());
+        ImGui_printLabel(color, "sampler threads", str_threads.c_str());
+        ImGui_printLabel(color, "background", str_background.c_str());
+        ImGui_printLabel(color, "engine", str_engine.c_str());
+        if(!str_bytecode.empty())
+            ImGui_printLabel(color, "bytecode", str_bytecode.c_str());
 
         ImGui::TreePop();
     }
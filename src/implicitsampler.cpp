@@ -0,0 +1,412 @@
+#include "include/implicitsampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+// Corners of the blocks of a whole tile
+static constexpr int MAX_CORNERS = (ImplicitSampler::TILE_CELLS / ImplicitSampler::BLOCK_CELLS) *
+                                   (ImplicitSampler::TILE_CELLS / ImplicitSampler::BLOCK_CELLS) *
+                                   (ImplicitSampler::BLOCK_CELLS + 1) * (ImplicitSampler::BLOCK_CELLS + 1);
+
+// Rewrites "lhs = rhs" into "(lhs) - (rhs)", comparisons (==, !=, <=, >=) are left alone
+static std::string implicit_form (const std::string& func)
+{
+    size_t equals = std::string::npos;
+    for(size_t i = 0; i < func.size(); i++)
+    {
+        if(func[i] != '=')
+            continue;
+
+        const bool comparison = (i > 0 && std::string("=!<>").find(func[i - 1]) != std::string::npos) ||
+                                (i + 1 < func.size() && func[i + 1] == '=');
+        if(comparison)
+            continue;
+        if(equals != std::string::npos)
+            return func; // not a single equation
+        equals = i;
+    }
+
+    if(equals == std::string::npos)
+        return func;
+    return "(" + func.substr(0, equals) + ") - (" + func.substr(equals + 1) + ")";
+}
+
+// Segments of every marching squares case, as pairs of edges ending with -1.
+// Corner k is below zero if bit k is set, corners go (x0,y0) (x1,y0) (x1,y1) (x0,y1)
+// and edge k joins corner k to corner k + 1. Saddles (5 and 10) are resolved by the caller
+static const signed char segment_table[16][5] =
+{
+    {-1},           {3, 0, -1},     {0, 1, -1},     {3, 1, -1},
+    {1, 2, -1},     {-1},           {0, 2, -1},     {3, 2, -1},
+    {2, 3, -1},     {0, 2, -1},     {-1},           {1, 2, -1},
+    {1, 3, -1},     {0, 1, -1},     {3, 0, -1},     {-1}
+};
+
+/*
+ *
+ * ImplicitSampler
+ *
+ */
+
+ImplicitSampler::ImplicitSampler (unsigned int _threadCount)
+{
+    if(_threadCount == 0)
+        _threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for(unsigned int i = 0; i < _threadCount; i++)
+    {
+        Worker* worker = new Worker;
+        worker->X.resize(MAX_CORNERS);
+        worker->Y.resize(MAX_CORNERS);
+        worker->F.resize(MAX_CORNERS);
+        bindParsers(*worker);
+        workers.emplace_back(worker);
+    }
+    compile();
+
+    for(unsigned int i = 1; i < _threadCount; i++)
+        threads.emplace_back(&ImplicitSampler::workerLoop, this, i);
+}
+
+ImplicitSampler::~ImplicitSampler ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+
+    for(std::thread& thread : threads)
+        thread.join();
+}
+
+/*
+ *
+ * Function
+ *
+ */
+
+void ImplicitSampler::setFunction (const char* func)
+{
+    setFunctions({func});
+}
+
+// Throws mu::Parser::exception_type and keeps the previous functions if any new one is invalid
+void ImplicitSampler::setFunctions (const std::vector<std::string>& funcs)
+{
+    if(funcs.empty())
+        throw mu::Parser::exception_type("no function");
+
+    mu::Parser parser;
+    double x = 0.0, y = 0.0;
+    parser.DefineVar("x", &x);
+    parser.DefineVar("y", &y);
+    for(const std::string& func : funcs)
+    {
+        parser.SetExpr(implicit_form(func));
+        parser.Eval();
+    }
+
+    functions = funcs;
+    for(std::unique_ptr<Worker>& worker : workers)
+        bindParsers(*worker);
+
+    compile();
+}
+
+// One parser per function, all bound to the worker's corners
+void ImplicitSampler::bindParsers (Worker& worker)
+{
+    worker.parsers.resize(functions.size());
+    for(size_t i = 0; i < functions.size(); i++)
+    {
+        if(!worker.parsers[i])
+        {
+            worker.parsers[i].reset(new mu::Parser);
+            worker.parsers[i]->DefineVar("x", worker.X.data());
+            worker.parsers[i]->DefineVar("y", worker.Y.data());
+        }
+        worker.parsers[i]->SetExpr(implicit_form(functions[i]));
+    }
+    worker.vertices.resize(functions.size());
+}
+
+// Lowers the current functions for the interval culling, the parsers evaluate the corners
+void ImplicitSampler::compile ()
+{
+    programs.resize(functions.size());
+
+    Worker& worker = *workers[0];
+    for(size_t i = 0; i < functions.size(); i++)
+    {
+        programs[i].reset(new Program);
+        Program& program = *programs[i];
+
+        mu::Parser& parser = *worker.parsers[i];
+        parser.Eval(); // makes sure the bytecode exists
+
+        if(program.bytecode.load(parser, worker.X.data()))
+            program.interval.load(program.bytecode, worker.Y.data());
+    }
+}
+
+/*
+ *
+ * Sampling
+ *
+ */
+
+void ImplicitSampler::sample
+(
+    double left, double right,
+    double bottom, double top,
+    double step,
+    double originX, double originY,
+    float ratioX, float ratioY
+)
+{
+    vertices.clear();
+    curveFirst.clear();
+    tileCount = 0;
+    culled = 0;
+    evaluated = 0;
+
+    if(!(step > 0.0) || !(right > left) || !(top > bottom))
+        return;
+
+    Job current = {};
+    current.firstI = static_cast<long long>(std::floor(left   / step));
+    current.firstJ = static_cast<long long>(std::floor(bottom / step));
+    current.lastI  = static_cast<long long>(std::ceil (right  / step));
+    current.lastJ  = static_cast<long long>(std::ceil (top    / step));
+    current.tilesI = static_cast<int>((current.lastI - current.firstI + TILE_CELLS - 1) / TILE_CELLS);
+    current.tilesJ = static_cast<int>((current.lastJ - current.firstJ + TILE_CELLS - 1) / TILE_CELLS);
+    current.items  = current.tilesI * current.tilesJ * getFunctionCount();
+    current.step = step;
+    current.originX = originX;
+    current.originY = originY;
+    current.ratioX = ratioX;
+    current.ratioY = ratioY;
+
+    for(std::unique_ptr<Worker>& worker : workers)
+    {
+        for(std::vector<float>& segments : worker->vertices)
+            segments.clear();
+        worker->culled = 0;
+        worker->evaluated = 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = current;
+        next = 0;
+        pending = static_cast<int>(threads.size());
+        error = nullptr;
+        generation++;
+    }
+    wake.notify_all();
+
+    std::exception_ptr callerError;
+    try
+    {
+        work(*workers[0]);
+    }
+    catch (...)
+    {
+        callerError = std::current_exception();
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]{ return pending == 0; });
+    }
+
+    if(callerError) std::rethrow_exception(callerError);
+    if(error)       std::rethrow_exception(error);
+
+    // the segments of a curve are in no particular order, GL_LINES does not mind
+    for(int function = 0; function < getFunctionCount(); function++)
+    {
+        curveFirst.push_back(static_cast<int>(vertices.size() / 2));
+        for(std::unique_ptr<Worker>& worker : workers)
+            vertices.insert(vertices.end(), worker->vertices[function].begin(), worker->vertices[function].end());
+    }
+    for(std::unique_ptr<Worker>& worker : workers)
+    {
+        culled += worker->culled;
+        evaluated += worker->evaluated;
+    }
+    tileCount = current.items;
+}
+
+// Takes tiles until there are none left
+void ImplicitSampler::work (Worker& worker)
+{
+    const int tiles = job.tilesI * job.tilesJ;
+    for(int item = next++; item < job.items; item = next++)
+        sampleTile(worker, item / tiles, item % tiles);
+}
+
+void ImplicitSampler::sampleTile (Worker& worker, int function, int tile)
+{
+    const long long i = job.firstI + static_cast<long long>(tile % job.tilesI) * TILE_CELLS;
+    const long long j = job.firstJ + static_cast<long long>(tile / job.tilesI) * TILE_CELLS;
+
+    worker.blocks.clear();
+    cull(worker, function, i, j, TILE_CELLS);
+    if(worker.blocks.empty())
+        return;
+
+    // the corners of all the blocks left, in one bulk
+    int corners = 0;
+    for(const Block& block : worker.blocks)
+    {
+        for(int b = 0; b <= block.height; b++)
+        {
+            for(int a = 0; a <= block.width; a++)
+            {
+                worker.X[corners] = (block.i + a) * job.step;
+                worker.Y[corners] = (block.j + b) * job.step;
+                corners++;
+            }
+        }
+    }
+    worker.parsers[function]->Eval(worker.F.data(), corners);
+    worker.evaluated += corners;
+
+    const double* F = worker.F.data();
+    for(const Block& block : worker.blocks)
+    {
+        march(worker, function, block, F);
+        F += (block.width + 1) * (block.height + 1);
+    }
+}
+
+// Splits the size x size cells at (i, j) down to blocks, skipping the parts whose enclosure excludes zero
+void ImplicitSampler::cull (Worker& worker, int function, long long i, long long j, int size)
+{
+    const int width  = static_cast<int>(std::min<long long>(size, job.lastI - i));
+    const int height = static_cast<int>(std::min<long long>(size, job.lastJ - j));
+    if(width <= 0 || height <= 0)
+        return;
+
+    const IntervalEvaluator& interval = programs[function]->interval;
+    if(interval.isLoaded())
+    {
+        const Interval bounds = interval.eval({ i * job.step, (i + width)  * job.step},
+                                              { j * job.step, (j + height) * job.step});
+        if(bounds.isEmpty() || bounds.lo > 0.0 || bounds.hi < 0.0)
+        {
+            worker.culled++;
+            return;
+        }
+    }
+
+    if(size <= BLOCK_CELLS)
+    {
+        worker.blocks.push_back({i, j, width, height});
+        return;
+    }
+
+    const int half = size / 2;
+    cull(worker, function, i,        j,        half);
+    cull(worker, function, i + half, j,        half);
+    cull(worker, function, i,        j + half, half);
+    cull(worker, function, i + half, j + half, half);
+}
+
+// Marching squares over the cells of a block, F holds its corners row by row
+void ImplicitSampler::march (Worker& worker, int function, const Block& block, const double* F)
+{
+    std::vector<float>& out = worker.vertices[function];
+    const int row = block.width + 1;
+
+    for(int b = 0; b < block.height; b++)
+    {
+        for(int a = 0; a < block.width; a++)
+        {
+            const double v[4] =
+            {
+                F[b * row + a],           F[b * row + a + 1],
+                F[(b + 1) * row + a + 1], F[(b + 1) * row + a]
+            };
+            if(!std::isfinite(v[0]) || !std::isfinite(v[1]) || !std::isfinite(v[2]) || !std::isfinite(v[3]))
+                continue;
+
+            const int index = (v[0] < 0.0) | (v[1] < 0.0) << 1 | (v[2] < 0.0) << 2 | (v[3] < 0.0) << 3;
+            if(index == 0 || index == 15)
+                continue;
+
+            const double x0 = (block.i + a) * job.step, x1 = x0 + job.step;
+            const double y0 = (block.j + b) * job.step, y1 = y0 + job.step;
+            const double cx[4] = {x0, x1, x1, x0};
+            const double cy[4] = {y0, y0, y1, y1};
+
+            auto edge = [&](int e)
+            {
+                const int k = (e + 1) & 3;
+                const double t = v[e] / (v[e] - v[k]);
+                out.push_back(static_cast<float>(job.originX + (cx[e] + (cx[k] - cx[e]) * t) * job.ratioX));
+                out.push_back(static_cast<float>(job.originY + (cy[e] + (cy[k] - cy[e]) * t) * job.ratioY));
+            };
+
+            if(index == 5 || index == 10)
+            {
+                // cut off the corners on the other side than the center
+                const bool center = (v[0] + v[1] + v[2] + v[3]) < 0.0;
+                if((index == 5) != center)
+                {
+                    edge(3); edge(0);
+                    edge(1); edge(2);
+                }
+                else
+                {
+                    edge(0); edge(1);
+                    edge(2); edge(3);
+                }
+                continue;
+            }
+
+            for(const signed char* e = segment_table[index]; *e >= 0; e++)
+                edge(*e);
+        }
+    }
+}
+
+void ImplicitSampler::workerLoop (int index)
+{
+    Worker& worker = *workers[index];
+    unsigned int seen = 0;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for(;;)
+    {
+        wake.wait(lock, [&]{ return quit || generation != seen; });
+        if(quit)
+            return;
+
+        seen = generation;
+        lock.unlock();
+
+        std::exception_ptr tileError;
+        try
+        {
+            work(worker);
+        }
+        catch (...)
+        {
+            tileError = std::current_exception();
+        }
+
+        lock.lock();
+        if(tileError && !error)
+            error = tileError;
+        if(--pending == 0)
+            done.notify_one();
+    }
+}
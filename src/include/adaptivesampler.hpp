@@ -0,0 +1,132 @@
+/*
+ *
+ * AdaptiveSampler
+ * Samples the plotted functions densely only where the curves need it
+ *
+ * The domain starts as a coarse grid of intervals. Every pass evaluates the
+ * midpoints of all the unfinished intervals in one batch (so every Sampler
+ * engine applies) and splits an interval only while its midpoint lies further
+ * than "tolerance" pixels from the chord, measured at the current camera zoom.
+ *
+ * An interval that still deviates once it is narrower than MIN_WIDTH pixels
+ * and whose rise does not spread over both of its halves holds a discontinuity,
+ * the curve is split into separate line strips there.
+ * Non-finite values split the curve as well.
+ * Every function of the Sampler is refined on its own, their vertices are
+ * written one curve after the other into the same array.
+ *
+ * When the Sampler can enclose f over an interval, the enclosure settles it
+ * without evaluating its midpoint if it is empty (outside of the domain),
+ * off the visible band [bottom, top] or flatter than the tolerance.
+ * An interval whose enclosure is more than SPIKE_RATIO times taller than the
+ * span of its samples may hide a spike and keeps being split.
+ *
+ * When the Sampler gives exact slopes (see DualEvaluator), a half whose
+ * midpoint test passed is kept only if the cubic Hermite interpolant of its
+ * end slopes stays within the tolerance of the chord as well, which catches
+ * the wiggles a midpoint lying on the chord would hide.
+ *
+ */
+
+#ifndef ADAPTIVESAMPLER_H
+#define ADAPTIVESAMPLER_H
+
+#include "sampler.hpp"
+#include "expression/interval.hpp"
+#include <vector>
+
+
+class AdaptiveSampler
+{
+public:
+    static constexpr int    MAX_POINTS    = 1 << 16; // refinement stops past this many samples
+    static constexpr double INITIAL_WIDTH = 16.0;    // width of the starting intervals in pixels
+    static constexpr double MIN_WIDTH     = 1.0 / 64.0; // narrowest interval in pixels
+    static constexpr double JUMP_SHARE    = 0.9;     // share of the rise kept by one half of a discontinuity
+    static constexpr double SPIKE_RATIO   = 4.0;     // enclosure to samples height above which an interval is split
+
+    // Samples every f over [start, end] and writes the vertices {originX + x * ratioX, originY + f(x) * ratioY},
+    // "zoom" is the camera zoom (pixels per world unit), the curves are refined only within [bottom, top]
+    void sample (Sampler& sampler,
+                 double start, double end,
+                 double bottom, double top,
+                 double originX, double originY,
+                 float ratioX, float ratioY,
+                 float zoom);
+
+    inline void setTolerance (float _tolerance);
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline       float               getTolerance     () const;
+    inline       int                 getPointsCount   () const; // vertices written by the last sample()
+    inline       int                 getStripsCount   () const;
+    inline       int                 getPasses        () const; // of the deepest curve
+    inline       int                 getCulled        () const; // intervals settled by their enclosure
+    inline       int                 getTangentSplits () const; // halves split by their slopes only
+    inline       bool                hasTangents      () const; // the last sample() checked the slopes
+    inline const std::vector<float>& getVertices      () const;
+    inline const std::vector<int>&   getStripFirst    () const;
+    inline const std::vector<int>&   getStripCount    () const;
+    inline const std::vector<int>&   getCurveFirst    () const;
+
+private:
+    enum State : unsigned char
+    {
+        Done,   // the chord is close enough to the curve
+        Split,  // to be subdivided in the next pass
+        Break   // holds a discontinuity, no line is drawn across it
+    };
+
+    void refine (Sampler& sampler, int function, double scaleX, double scaleY, double bottom, double top);
+    void emit (double originX, double originY, float ratioX, float ratioY);
+
+    float tolerance = 0.5f; // pixels
+    int passes = 0;
+    int culled = 0;
+    int tangentSplits = 0;
+    bool tangents = false;
+
+    // samples in ascending x, state[i] describes the interval [X[i], X[i + 1]], S holds the slopes if "tangents"
+    std::vector<double> X, Y, S;
+    std::vector<State> state;
+
+    // scratch buffers of a pass
+    std::vector<double> midX, midY, midS;
+    std::vector<Interval> midBounds; // enclosures of the intervals being split
+    std::vector<double> nextX, nextY, nextS;
+    std::vector<State> nextState;
+
+    std::vector<float> vertices;
+    std::vector<int> stripFirst; // first vertex of every line strip
+    std::vector<int> stripCount; // vertices of every line strip
+    std::vector<int> curveFirst; // first vertex of every function
+};
+
+
+inline void AdaptiveSampler::setTolerance (float _tolerance) { tolerance = _tolerance; }
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline       float               AdaptiveSampler::getTolerance     () const { return tolerance;                                   }
+inline       int                 AdaptiveSampler::getPointsCount   () const { return static_cast<int>(vertices.size() / 2);       }
+inline       int                 AdaptiveSampler::getStripsCount   () const { return static_cast<int>(stripFirst.size());         }
+inline       int                 AdaptiveSampler::getPasses        () const { return passes;                                      }
+inline       int                 AdaptiveSampler::getCulled        () const { return culled;                                      }
+inline       int                 AdaptiveSampler::getTangentSplits () const { return tangentSplits;                               }
+inline       bool                AdaptiveSampler::hasTangents      () const { return tangents;                                    }
+inline const std::vector<float>& AdaptiveSampler::getVertices      () const { return vertices;                                    }
+inline const std::vector<int>&   AdaptiveSampler::getStripFirst    () const { return stripFirst;                                  }
+inline const std::vector<int>&   AdaptiveSampler::getStripCount    () const { return stripCount;                                  }
+inline const std::vector<int>&   AdaptiveSampler::getCurveFirst    () const { return curveFirst;                                  }
+
+
+#endif /* ADAPTIVESAMPLER_H */
@@ -0,0 +1,119 @@
+/*
+ *
+ * AsyncSampler
+ * Evaluates the functions on a background thread
+ *
+ * The background thread owns a Sampler of its own, so a job never shares a
+ * parser with the render thread. Jobs are evaluated in chunks of CHUNK_SIZE
+ * samples, a newer submit() or a cancel() abandons the job in flight at the
+ * next chunk. Finished vertex buffers reach the render thread through a
+ * lock-free SpscQueue, and go back to the worker through another one to be reused.
+ *
+ */
+
+#ifndef ASYNCSAMPLER_H
+#define ASYNCSAMPLER_H
+
+#include "sampler.hpp"
+#include "spscqueue.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+class AsyncSampler
+{
+public:
+    // Samples evaluated between two checks for a superseded job
+    static constexpr int CHUNK_SIZE = 1 << 16;
+
+    // Arguments of Sampler::sample(), plus the functions to evaluate
+    struct Request
+    {
+        std::vector<std::string> functions;
+        Sampler::Engine engine = Sampler::Interpreter;
+        SimdEvaluator::Isa isa = SimdEvaluator::Scalar;
+        int derivative = 0;
+        int count = 0;
+        double start = 0.0, step = 0.0;
+        double originX = 0.0, originY = 0.0;
+        float ratioX = 0.0f, ratioY = 0.0f;
+    };
+
+    struct Result
+    {
+        std::vector<float> vertices; // "count" vertices per curve, one curve after the other
+        int count = 0;
+        int curves = 0;
+        double originX = 0.0, originY = 0.0; // of the request
+        unsigned int generation = 0;
+        std::string error; // set if the evaluation threw
+    };
+
+    AsyncSampler ();
+    ~AsyncSampler ();
+
+    AsyncSampler (const AsyncSampler&) = delete;
+    AsyncSampler& operator= (const AsyncSampler&) = delete;
+
+    // Render thread side
+    void submit  (const Request& request); // supersedes the job in flight
+    void cancel  ();
+    bool poll    (Result& result);         // pops the result of the latest job, older ones are dropped
+    void recycle (Result& result);         // hands the vertex buffer back to the worker
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline bool  isBusy      () const;
+    inline float getProgress () const; // [0, 1] of the job in flight
+
+private:
+    void workerLoop ();
+    void run (const Request& request, unsigned int generation);
+
+    Sampler sampler;
+    std::thread thread;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    Request request;      // latest submitted, not yet taken by the worker
+    bool requested = false;
+    bool quit = false;
+
+    std::atomic<unsigned int> generation {0}; // bumped by every submit() and cancel()
+    std::atomic<bool> queued {false};
+    std::atomic<bool> running {false};
+    std::atomic<int> progress {0};
+    std::atomic<int> total {0};
+
+    SpscQueue<Result, 4> results;              // worker -> render thread
+    SpscQueue<std::vector<float>, 4> buffers;  // render thread -> worker
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline bool AsyncSampler::isBusy () const
+{
+    return queued.load() || running.load();
+}
+
+inline float AsyncSampler::getProgress () const
+{
+    const int t = total.load();
+    return (t > 0) ? static_cast<float>(progress.load()) / t : 0.0f;
+}
+
+
+#endif /* ASYNCSAMPLER_H */
@@ -3,6 +3,14 @@
  *
  * Based on javidx9's video on panning and zooming (https://www.youtube.com/watch?v=ZQ8qtAizis4)
  * and Joey De Vries' OpenGL tutorial on Cameras   (https://learnopengl.com/Getting-started/Camera)
+ *
+ * World coordinates are kept in double. Floats lose pixels once the camera
+ * looks deep into the plane, so everything sent to the GPU is relative to a
+ * floating origin near the view: the projection matrix only scales around the
+ * view center, and the "residual" offset from the origin to the view center
+ * goes into the Camera uniform block next to it. The origin is re-based onto
+ * the view center only when the view drifts REBASE_PIXELS away from it, which
+ * forces whatever was written against the old origin to be rewritten.
  */
 
 #ifndef CAMERA_H
@@ -13,6 +21,9 @@
 class Camera
 {
 public:
+    // Distance in pixels from the floating origin past which float vertices lose a hundredth of a pixel
+    static constexpr double REBASE_PIXELS = 1 << 16;
+
     // Used in Camera::move()
     enum Direction
     {
@@ -66,10 +77,10 @@ public:
     inline void update_pan (const glm::vec2& screen);
 
     // Coordinate system conversion
-           glm::vec2 ScreenToWorld (float screenX, float screenY) const;
-    inline glm::vec2 ScreenToWorld (const glm::vec2 &screen) const;
-           glm::vec2 WorldToScreen (float worldX, float worldY) const;
-    inline glm::vec2 WorldToScreen (const glm::vec2 &world) const;
+           glm::dvec2 ScreenToWorld (double screenX, double screenY) const;
+    inline glm::dvec2 ScreenToWorld (const glm::vec2 &screen) const;
+           glm::dvec2 WorldToScreen (double worldX, double worldY) const;
+    inline glm::dvec2 WorldToScreen (const glm::dvec2 &world) const;
 
     /*
      *
@@ -81,7 +92,16 @@ public:
     inline float getSpeed () const;
 
     inline const glm::vec2& getPosition         () const;
-    inline const glm::mat4& getProjectionMatrix () const;
+    inline const glm::mat4& getProjectionMatrix () const; // around the view center
+
+    // World-space corners of the screen, as of the last updateProjectionMatrix()
+    inline const glm::dvec2& getViewMin         () const;
+    inline const glm::dvec2& getViewMax         () const;
+
+    // Floating origin, see above
+    inline const glm::dvec2& getOrigin          () const;
+    inline const glm::vec2&  getResidual        () const; // view center - origin
+    inline       int         getRebaseCount     () const;
 
     /*
      *
@@ -101,7 +121,14 @@ private:
     glm::mat4 projection = {};
     glm::vec2 position;
 
-    glm::vec2 offset = {0.0f, 0.0f};
+    glm::dvec2 viewMin = {0.0, 0.0}; // left top
+    glm::dvec2 viewMax = {0.0, 0.0}; // right bottom
+
+    glm::dvec2 origin = {0.0, 0.0};
+    glm::vec2 residual = {0.0f, 0.0f};
+    int rebaseCount = 0;
+
+    glm::dvec2 offset = {0.0, 0.0};
     glm::vec2 startPan = {0.0f, 0.0f};
 };
 
@@ -115,8 +142,8 @@ inline void Camera::zoom_by          (float yOffset)                       { zoo
 inline void Camera::zoom_on_position (const glm::vec2& pos, float yOffset) { zoom_on_position(pos.x, pos.y, yOffset); }
 
 // Coordinate system conversion
-inline glm::vec2 Camera::WorldToScreen (const glm::vec2 &world)  const { return WorldToScreen(world.x, world.y);   }
-inline glm::vec2 Camera::ScreenToWorld (const glm::vec2 &screen) const { return ScreenToWorld(screen.x, screen.y); }
+inline glm::dvec2 Camera::WorldToScreen (const glm::dvec2 &world) const { return WorldToScreen(world.x, world.y);   }
+inline glm::dvec2 Camera::ScreenToWorld (const glm::vec2 &screen) const { return ScreenToWorld(screen.x, screen.y); }
 
 /*
  *
@@ -124,10 +151,15 @@ inline glm::vec2 Camera::ScreenToWorld (const glm::vec2 &screen) const { return
  *
  */
 
-inline       float      Camera::getZoom             () const { return zoom;       }
-inline       float      Camera::getSpeed            () const { return speed;      }
-inline const glm::vec2& Camera::getPosition         () const { return position;   }
-inline const glm::mat4& Camera::getProjectionMatrix () const { return projection; }
+inline       float       Camera::getZoom             () const { return zoom;        }
+inline       float       Camera::getSpeed            () const { return speed;       }
+inline const glm::vec2&  Camera::getPosition         () const { return position;    }
+inline const glm::mat4&  Camera::getProjectionMatrix () const { return projection;  }
+inline const glm::dvec2& Camera::getViewMin          () const { return viewMin;     }
+inline const glm::dvec2& Camera::getViewMax          () const { return viewMax;     }
+inline const glm::dvec2& Camera::getOrigin           () const { return origin;      }
+inline const glm::vec2&  Camera::getResidual         () const { return residual;    }
+inline       int         Camera::getRebaseCount      () const { return rebaseCount; }
 
 /*
  *
@@ -10,6 +10,7 @@
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
+#include "glstate.hpp"
 
 
 class Container
@@ -23,6 +24,7 @@ public:
 
     void update_VAO ();
     void update_VBO ();
+    void update_VBO (GLsizei first, GLsizei count); // uploads vertices[first, first + count), the buffer must already hold them
     void update_EBO ();
 
     /*
@@ -123,18 +125,18 @@ inline GLsizei Container::getEBOSize () const { return EBOsize; }
 
 // VBO
 inline void Container::gen_VBO  ()       { glGenBuffers   (1, &m_VBO); }
-inline void Container::del_VBO  ()       { glDeleteBuffers(1, &m_VBO); }
-inline void Container::bind_VBO () const { glBindBuffer(GL_ARRAY_BUFFER, m_VBO); }
+inline void Container::del_VBO  ()       { GLState::releaseBuffer(m_VBO); glDeleteBuffers(1, &m_VBO); }
+inline void Container::bind_VBO () const { GLState::bindArrayBuffer(m_VBO); }
 
 // EBO
 inline void Container::gen_EBO  ()       { glGenBuffers   (1, &m_EBO); }
-inline void Container::del_EBO  ()       { glDeleteBuffers(1, &m_EBO); }
+inline void Container::del_EBO  ()       { GLState::releaseBuffer(m_EBO); glDeleteBuffers(1, &m_EBO); }
 inline void Container::bind_EBO () const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_EBO); }
 
 // VAO
 inline void Container::gen_VAO  ()       { glGenVertexArrays   (1, &m_VAO); }
-inline void Container::del_VAO  ()       { glDeleteVertexArrays(1, &m_VAO); }
-inline void Container::bind_VAO () const { glBindVertexArray       (m_VAO); }
+inline void Container::del_VAO  ()       { GLState::releaseVertexArray(m_VAO); glDeleteVertexArrays(1, &m_VAO); }
+inline void Container::bind_VAO () const { GLState::bindVertexArray(m_VAO); }
 
 
 #endif /* CONTAINER_H */
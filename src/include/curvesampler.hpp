@@ -0,0 +1,147 @@
+/*
+ *
+ * CurveSampler
+ * Samples parametric curves (x(t), y(t)) and polar curves r(t) by arc length
+ *
+ * A parametric function is written "x(t), y(t)", a polar one "r(t)" with t the
+ * angle, giving (r cos t, r sin t). Both coordinates of a curve are evaluated
+ * in the same bulk pass over the parameters.
+ *
+ * A pilot pass takes PILOT_POINTS evenly spaced parameters. Every next pass
+ * places the samples at equal steps of screen-space arc length measured on the
+ * previous one, about one per "spacing" pixels, so tight spirals get as many
+ * samples as their length on screen needs and long straight runs few.
+ * UNIFORM_SHARE of the samples stay evenly spaced in t, which keeps finding
+ * the pieces the previous pass missed or could not measure (non-finite samples).
+ * Non-finite samples split the curve into separate line strips.
+ *
+ */
+
+#ifndef CURVESAMPLER_H
+#define CURVESAMPLER_H
+
+#include "muParser/muParser.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+
+class CurveSampler
+{
+public:
+    static constexpr int    PILOT_POINTS  = 1 << 10;
+    static constexpr int    MAX_POINTS    = 1 << 16; // per curve
+    static constexpr int    PASSES        = 3;       // pilot included
+    static constexpr double UNIFORM_SHARE = 0.1;
+
+    enum Kind
+    {
+        Parametric, // "x(t), y(t)"
+        Polar       // "r(t)"
+    };
+
+    CurveSampler (Kind _kind);
+
+    CurveSampler (const CurveSampler&) = delete;
+    CurveSampler& operator= (const CurveSampler&) = delete;
+
+    /*
+     *
+     * Function
+     *
+     */
+
+    void setFunction  (const char* func); // a single function
+    void setFunctions (const std::vector<std::string>& funcs);
+
+    void setRange (double _tMin, double _tMax); // of the parameter
+    inline void setSpacing (float _spacing);
+
+    /*
+     *
+     * Sampling
+     *
+     */
+
+    // Samples every curve over [tMin, tMax] and writes the vertices {originX + x(t) * ratioX, originY + y(t) * ratioY},
+    // "zoom" is the camera zoom (pixels per world unit)
+    void sample (double originX, double originY,
+                 float ratioX, float ratioY,
+                 float zoom);
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline       Kind                      getKind          () const;
+    inline       int                       getFunctionCount () const;
+    inline const std::string&              getFunction      (int function = 0) const;
+    inline const std::vector<std::string>& getFunctions     () const;
+    inline       double                    getRangeMin      () const;
+    inline       double                    getRangeMax      () const;
+    inline       float                     getSpacing       () const;
+    inline       int                       getPointsCount   () const; // vertices written by the last sample()
+    inline       int                       getStripsCount   () const;
+    inline const std::vector<float>&       getVertices      () const;
+    inline const std::vector<int>&         getStripFirst    () const;
+    inline const std::vector<int>&         getStripCount    () const;
+    inline const std::vector<int>&         getCurveFirst    () const;
+
+private:
+    // Parsers of a curve, "y" is unused by polar curves
+    struct Program
+    {
+        mu::Parser x;
+        mu::Parser y;
+    };
+
+    void bind (Program& program, const std::string& func);
+    void evaluate (Program& program, int count);
+    double measureLength (int count, double scaleX, double scaleY);
+    void place (int count, int next);
+    void emit (int count, double originX, double originY, float ratioX, float ratioY);
+
+    Kind kind;
+    std::vector<std::string> functions;
+    std::vector<std::unique_ptr<Program>> programs; // one per function
+    double tMin;
+    double tMax;
+    float spacing = 2.0f; // pixels between samples
+
+    // samples of the current pass, T is bound to "t"
+    std::vector<double> T, X, Y;
+    std::vector<double> measure, nextT; // scratch buffers of place()
+
+    std::vector<float> vertices;
+    std::vector<int> stripFirst; // first vertex of every line strip
+    std::vector<int> stripCount; // vertices of every line strip
+    std::vector<int> curveFirst; // first vertex of every function
+};
+
+
+inline void CurveSampler::setSpacing (float _spacing) { spacing = _spacing; }
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline       CurveSampler::Kind        CurveSampler::getKind          ()             const { return kind;                                   }
+inline       int                       CurveSampler::getFunctionCount ()             const { return static_cast<int>(functions.size());     }
+inline const std::string&              CurveSampler::getFunction      (int function) const { return functions[function];                    }
+inline const std::vector<std::string>& CurveSampler::getFunctions     ()             const { return functions;                              }
+inline       double                    CurveSampler::getRangeMin      ()             const { return tMin;                                   }
+inline       double                    CurveSampler::getRangeMax      ()             const { return tMax;                                   }
+inline       float                     CurveSampler::getSpacing       ()             const { return spacing;                                }
+inline       int                       CurveSampler::getPointsCount   ()             const { return static_cast<int>(vertices.size() / 2);  }
+inline       int                       CurveSampler::getStripsCount   ()             const { return static_cast<int>(stripFirst.size());    }
+inline const std::vector<float>&       CurveSampler::getVertices      ()             const { return vertices;                               }
+inline const std::vector<int>&         CurveSampler::getStripFirst    ()             const { return stripFirst;                             }
+inline const std::vector<int>&         CurveSampler::getStripCount    ()             const { return stripCount;                             }
+inline const std::vector<int>&         CurveSampler::getCurveFirst    ()             const { return curveFirst;                             }
+
+
+#endif /* CURVESAMPLER_H */
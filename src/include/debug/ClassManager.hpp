@@ -12,6 +12,9 @@
 #include "../graph.hpp"
 #include "../object.hpp"
 #include "../container.hpp"
+#include "../ringcontainer.hpp"
+#include "../streamcontainer.hpp"
+#include "../frameprofiler.hpp"
 
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
@@ -29,16 +32,25 @@ public:
     static inline void ImGui_printClassData (const Graph& graph);
     static inline void ImGui_printClassData (const Object& object);
     static inline void ImGui_printClassData (const Container* container);
+    static inline void ImGui_printClassData (const RingContainer* ring);
+    static inline void ImGui_printClassData (const StreamContainer* stream);
+    static inline void ImGui_printClassData (const FrameProfiler& profiler);
     static inline void ImGui_printClassData (const char *nodelabel, const Shader& shader);
     static inline void ImGui_printClassData (const char *nodelabel, const Camera& camera);
     static inline void ImGui_printClassData (const char *nodelabel, const Graph& graph);
     static inline void ImGui_printClassData (const char *nodelabel, const Object& object);
     static inline void ImGui_printClassData (const char *nodelabel, const Container* container);
+    static inline void ImGui_printClassData (const char *nodelabel, const RingContainer* ring);
+    static inline void ImGui_printClassData (const char *nodelabel, const StreamContainer* stream);
+    static inline void ImGui_printClassData (const char *nodelabel, const FrameProfiler& profiler);
     static void ImGui_printClassData (const char* nodelabel, const char* type, const Shader& shader);
     static void ImGui_printClassData (const char* nodelabel, const char* type, const Camera& camera);
     static void ImGui_printClassData (const char* nodelabel, const char* type, const Graph& graph);
     static void ImGui_printClassData (const char* nodelabel, const char* type, const Object& object);
     static void ImGui_printClassData (const char* nodelabel, const char* type, const Container* container);
+    static void ImGui_printClassData (const char* nodelabel, const char* type, const RingContainer* ring);
+    static void ImGui_printClassData (const char* nodelabel, const char* type, const StreamContainer* stream);
+    static void ImGui_printClassData (const char* nodelabel, const char* type, const FrameProfiler& profiler);
     #pragma endregion
 
 private:
@@ -51,11 +63,17 @@ inline void ClassManager::ImGui_printClassData (const Camera&    camera)    { Im
 inline void ClassManager::ImGui_printClassData (const Graph&     graph)     { ImGui_printClassData("         ", "Graph",     graph);     }
 inline void ClassManager::ImGui_printClassData (const Object&    object)    { ImGui_printClassData("         ", "Object",    object);    }
 inline void ClassManager::ImGui_printClassData (const Container* container) { ImGui_printClassData("         ", "Container", container); }
+inline void ClassManager::ImGui_printClassData (const RingContainer* ring)   { ImGui_printClassData("         ", "RingContainer", ring);  }
+inline void ClassManager::ImGui_printClassData (const StreamContainer* stream) { ImGui_printClassData("         ", "StreamContainer", stream); }
+inline void ClassManager::ImGui_printClassData (const FrameProfiler& profiler) { ImGui_printClassData("         ", "FrameProfiler", profiler); }
 inline void ClassManager::ImGui_printClassData (const char* nodelabel, const Shader&    shader)    { ImGui_printClassData(nodelabel, "Shader   ", shader);    }
 inline void ClassManager::ImGui_printClassData (const char* nodelabel, const Camera&    camera)    { ImGui_printClassData(nodelabel, "Camera   ", camera);    }
 inline void ClassManager::ImGui_printClassData (const char* nodelabel, const Graph&     graph)     { ImGui_printClassData(nodelabel, "Graph    ", graph);     }
 inline void ClassManager::ImGui_printClassData (const char* nodelabel, const Object&    object)    { ImGui_printClassData(nodelabel, "Object   ", object);    }
 inline void ClassManager::ImGui_printClassData (const char* nodelabel, const Container* container) { ImGui_printClassData(nodelabel, "Container", container); }
+inline void ClassManager::ImGui_printClassData (const char* nodelabel, const RingContainer* ring)   { ImGui_printClassData(nodelabel, "RingContainer", ring);  }
+inline void ClassManager::ImGui_printClassData (const char* nodelabel, const StreamContainer* stream) { ImGui_printClassData(nodelabel, "StreamContainer", stream); }
+inline void ClassManager::ImGui_printClassData (const char* nodelabel, const FrameProfiler& profiler) { ImGui_printClassData(nodelabel, "FrameProfiler", profiler); }
 #pragma endregion
 
 
@@ -0,0 +1,139 @@
+/*
+ *
+ * Bytecode
+ * Engine-independent form of the muParser bytecode
+ *
+ * muParser's RPN is lowered into a flat list of primitive instructions:
+ * the fused tokens (x^2, a*x+b, ...) are expanded, the built-in functions
+ * are recognized by name and the if-then-else jumps are resolved to
+ * instruction indices. Every evaluation engine (JIT, SIMD, ...) works on
+ * this form, and its scalar interpreter is the reference they are checked against.
+ *
+ * Optimizer rewrites it: values used more than once are kept in temporaries
+ * (Store/Load) and the values independent of x are moved to the prologue,
+ * which prepare() evaluates into cells read back by Var instructions.
+ *
+ */
+
+#ifndef EXPRESSION_BYTECODE_H
+#define EXPRESSION_BYTECODE_H
+
+#include "../muParser/muParser.h"
+#include <string>
+#include <vector>
+
+
+class Bytecode
+{
+public:
+    enum Opcode
+    {
+        Const,  // push value
+        X,      // push the sampled variable
+        Var,    // push *var (any other variable)
+        Load,   // push temps[slot]
+        Store,  // temps[slot] = top of the stack, the value stays on the stack
+
+        Add, Sub, Mul, Div, Pow,
+        LT, LE, GT, GE, EQ, NEQ,
+        And, Or,
+
+        Call1,  // replace the top of the stack with fn1(top)
+        Call2,  // replace the top two values with fn2(a, b)
+
+        If,     // pop the condition, jump to "jump" if it equals zero
+        Else,   // jump to "jump" (the matching EndIf)
+        EndIf
+    };
+
+    // Functions recognized by name, Other is called through its pointer
+    enum Function
+    {
+        Other,
+        Neg, Plus,
+        Sin, Cos, Tan, ASin, ACos, ATan,
+        Sinh, Cosh, Tanh, ASinh, ACosh, ATanh,
+        Log, Log2, Log10, Exp, Sqrt, Abs, Sign, Rint
+    };
+
+    typedef double (*Function1) (double);
+    typedef double (*Function2) (double, double);
+
+    struct Instruction
+    {
+        Opcode op;
+        Function func     = Other;
+        double value      = 0.0;     // Const
+        const double* var = nullptr; // Var
+        Function1 fn1     = nullptr; // Call1
+        Function2 fn2     = nullptr; // Call2
+        int jump          = 0;       // If, Else
+        int slot          = 0;       // Load, Store
+    };
+
+    // Most temporaries an optimized bytecode may use
+    static constexpr int MAX_TEMPS = 64;
+
+    // Lowers the parser's bytecode, "X" is the address bound to the sampled variable.
+    // The expression must have been evaluated at least once.
+    // Returns false (and leaves the bytecode empty) if any token is not supported.
+    bool load (const mu::ParserBase& parser, const double* X);
+    void clear ();
+
+    // Replaces the instructions with an optimized equivalent, the Var instructions
+    // of "_instructions" with a null pointer read the prologue's cell "slot"
+    void assign (const std::vector<Instruction>& _instructions, const std::vector<Instruction>& _prologue,
+                 int _tempCount, int cellCount);
+
+    // Evaluates the prologue, call it once per sampling pass before eval().
+    // Copies of the bytecode keep reading the cells of the original
+    void prepare ();
+
+    // Reference scalar interpreter
+    double eval (double x) const;
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline       bool                      empty           () const;
+    inline       int                       getStackSize    () const;
+    inline       int                       getTempCount    () const;
+    inline const std::vector<Instruction>& getInstructions () const;
+    inline const std::vector<Instruction>& getPrologue     () const;
+    inline const std::string&              getError        () const;
+
+    static const char* getFunctionName (Function func);
+
+private:
+    void push (const Instruction& instruction);
+
+    std::vector<Instruction> instructions;
+    int stackSize = 0;
+    int tempCount = 0;
+    int depth = 0;
+
+    std::vector<Instruction> prologue;
+    std::vector<double> cells; // values computed by the prologue
+    int prologueStackSize = 0;
+    std::string error; // why the last load() failed
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline       bool                                 Bytecode::empty           () const { return instructions.empty(); }
+inline       int                                  Bytecode::getStackSize    () const { return stackSize;            }
+inline       int                                  Bytecode::getTempCount    () const { return tempCount;            }
+inline const std::vector<Bytecode::Instruction>& Bytecode::getInstructions () const { return instructions;         }
+inline const std::vector<Bytecode::Instruction>& Bytecode::getPrologue     () const { return prologue;             }
+inline const std::string&                         Bytecode::getError        () const { return error;                }
+
+
+#endif /* EXPRESSION_BYTECODE_H */
@@ -0,0 +1,60 @@
+/*
+ *
+ * DualEvaluator
+ * Evaluates the Bytecode together with its first two derivatives
+ *
+ * Forward-mode automatic differentiation: every value on the stack is a
+ * truncated Taylor series (f, f', f'') in x and every instruction applies
+ * the chain rule to it, so one pass gives f(x), f'(x) and f''(x) exact up to
+ * rounding. Finite differences would need three evaluations and lose about
+ * half of the digits.
+ * if-then-else follows the branch taken by the value, comparisons and the
+ * piecewise constant functions (sign, rint) have zero derivatives.
+ * Functions known only by their address are differentiated numerically.
+ *
+ */
+
+#ifndef EXPRESSION_DUAL_H
+#define EXPRESSION_DUAL_H
+
+#include "bytecode.hpp"
+
+
+struct Dual
+{
+    double value;
+    double d1; // f'
+    double d2; // f''
+};
+
+class DualEvaluator
+{
+public:
+    bool load  (const Bytecode& _bytecode);
+    void clear ();
+
+    Dual eval (double x) const;
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline bool isLoaded () const;
+
+private:
+    Bytecode bytecode;
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline bool DualEvaluator::isLoaded () const { return !bytecode.empty(); }
+
+
+#endif /* EXPRESSION_DUAL_H */
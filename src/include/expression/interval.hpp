@@ -0,0 +1,72 @@
+/*
+ *
+ * IntervalEvaluator
+ * Evaluates the Bytecode over a whole interval of abscissae
+ *
+ * The result is an enclosure [lo, hi] of every finite value f takes over [a, b],
+ * every bound is rounded outwards by one ulp to cover the rounding of libm.
+ * Points outside of a function's domain are dropped (sqrt([-1, 4]) = [0, 2]),
+ * an interval with no point in the domain gives an empty enclosure.
+ * if-then-else takes the hull of both branches when the condition is undecided.
+ * Functions without interval rules enclose to [-inf, inf].
+ * A second variable may be given an interval as well, see ImplicitSampler.
+ *
+ */
+
+#ifndef EXPRESSION_INTERVAL_H
+#define EXPRESSION_INTERVAL_H
+
+#include "bytecode.hpp"
+#include <limits>
+
+
+struct Interval
+{
+    double lo;
+    double hi;
+
+    inline bool isEmpty () const;
+
+    static inline Interval entire ();
+    static inline Interval empty  ();
+};
+
+class IntervalEvaluator
+{
+public:
+    // "Y" is the address bound to the second variable, its Var instructions read the "y" of eval()
+    bool load  (const Bytecode& _bytecode, const double* Y = nullptr);
+    void clear ();
+
+    // Enclosure of f over [x.lo, x.hi] (x [y.lo, y.hi])
+    Interval eval (Interval x, Interval y = Interval::entire()) const;
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline bool isLoaded () const;
+
+private:
+    Bytecode bytecode;
+    const double* varY = nullptr;
+};
+
+
+inline bool Interval::isEmpty () const { return !(lo <= hi); }
+
+inline Interval Interval::entire () { return {-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()}; }
+inline Interval Interval::empty  () { return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()}; }
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline bool IntervalEvaluator::isLoaded () const { return !bytecode.empty(); }
+
+
+#endif /* EXPRESSION_INTERVAL_H */
@@ -0,0 +1,72 @@
+/*
+ *
+ * JitFunction
+ * Compiles the Bytecode into x86-64 machine code
+ *
+ * The generated function keeps the value stack in its own stack frame,
+ * every stack slot sits at a fixed offset known at compile time.
+ * Arithmetic and comparisons are emitted as scalar SSE2 instructions,
+ * functions and pow() are called through their pointers.
+ * The code is written to a page mapped read-write and then remapped read-execute.
+ *
+ * compile() fails on any other architecture, the caller falls back to the interpreter.
+ *
+ */
+
+#ifndef EXPRESSION_JIT_H
+#define EXPRESSION_JIT_H
+
+#include "bytecode.hpp"
+#include <cstddef>
+#include <string>
+
+
+class JitFunction
+{
+public:
+    typedef double (*Function) (double x);
+
+    JitFunction () = default;
+    ~JitFunction ();
+
+    JitFunction (const JitFunction&) = delete;
+    JitFunction& operator= (const JitFunction&) = delete;
+
+    bool compile (const Bytecode& bytecode);
+    void release ();
+
+    inline double operator() (double x) const;
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline       bool         isCompiled  () const;
+    inline       std::size_t  getCodeSize () const;
+    inline const std::string& getError    () const;
+
+private:
+    Function function = nullptr;
+    void* memory = nullptr;
+    std::size_t memorySize = 0;
+    std::size_t codeSize = 0;
+    std::string error; // why the last compile() failed
+};
+
+
+inline double JitFunction::operator() (double x) const { return function(x); }
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline       bool         JitFunction::isCompiled  () const { return function != nullptr; }
+inline       std::size_t  JitFunction::getCodeSize () const { return codeSize;            }
+inline const std::string& JitFunction::getError    () const { return error;               }
+
+
+#endif /* EXPRESSION_JIT_H */
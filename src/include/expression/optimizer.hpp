@@ -0,0 +1,94 @@
+/*
+ *
+ * Optimizer
+ * Rewrites the Bytecode into a cheaper equivalent
+ *
+ * The instructions are rebuilt into an expression graph where equal
+ * subexpressions share a single node, then emitted back:
+ *  - operations on constants are folded into a constant,
+ *  - a value used more than once is computed once and kept in a temporary,
+ *  - a value independent of x (but depending on other variables) is moved to
+ *    the prologue, evaluated once per sampling pass by Bytecode::prepare().
+ * Values are shared only within the branch of an if-then-else they were built in,
+ * so every temporary is written before it is read on every path.
+ *
+ */
+
+#ifndef EXPRESSION_OPTIMIZER_H
+#define EXPRESSION_OPTIMIZER_H
+
+#include "bytecode.hpp"
+#include <map>
+#include <tuple>
+#include <vector>
+
+
+class Optimizer
+{
+public:
+    // Rewrites "bytecode" in place, returns false (and leaves it untouched)
+    // if it is empty or has already been optimized
+    bool run (Bytecode& bytecode);
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline int getInstructionsBefore () const; // of the last run()
+    inline int getInstructionsAfter  () const; // prologue excluded
+    inline int getFolded             () const; // operations replaced by a constant
+    inline int getShared             () const; // values kept in a temporary
+    inline int getHoisted            () const; // values moved to the prologue
+
+private:
+    struct Node
+    {
+        Bytecode::Instruction ins; // If stands for the whole if-then-else
+        int args[3]   = {-1, -1, -1};
+        int argc      = 0;
+        bool variant  = false; // depends on x
+        bool constant = false; // depends on no variable at all
+        int uses      = 0;
+        int slot      = -1;    // temporary once emitted
+        int cell      = -1;    // prologue cell once hoisted
+    };
+
+    // op, func, value bits, pointer, args, scope
+    typedef std::tuple<int, int, unsigned long long, const void*, int, int, int, int> Key;
+
+    int add (Node node, int scope);
+    int fold (const Node& node);
+    int select (int cond, int then, int otherwise, int scope);
+
+    bool hoistable (const Node& node) const;
+    void count (int index);
+    void emit (int index, std::vector<Bytecode::Instruction>& code, bool share);
+
+    std::vector<Node> nodes;
+    std::map<Key, int> unique; // hash-consing of the nodes
+    std::vector<Bytecode::Instruction> prologue;
+    int temps = 0;
+    int cells = 0;
+
+    int instructionsBefore = 0;
+    int instructionsAfter = 0;
+    int folded = 0;
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline int Optimizer::getInstructionsBefore () const { return instructionsBefore; }
+inline int Optimizer::getInstructionsAfter  () const { return instructionsAfter;  }
+inline int Optimizer::getFolded             () const { return folded;             }
+inline int Optimizer::getShared             () const { return temps;              }
+inline int Optimizer::getHoisted            () const { return cells;              }
+
+
+#endif /* EXPRESSION_OPTIMIZER_H */
@@ -0,0 +1,84 @@
+/*
+ *
+ * SimdEvaluator
+ * Evaluates the Bytecode over several abscissae at once
+ *
+ * Every instruction operates on a whole register of abscissae:
+ * 4 with AVX2 (__m256d) and 2 with SSE2 (__m128d).
+ * sin, cos, tan, exp and log are computed with polynomial kernels,
+ * if-then-else evaluates both branches and blends them with the condition mask.
+ * Functions without a vector kernel are called once per lane.
+ *
+ * The instruction set is picked at runtime from cpuid, the Scalar set runs
+ * the reference interpreter of the Bytecode and is used for correctness checks.
+ *
+ */
+
+#ifndef EXPRESSION_SIMD_H
+#define EXPRESSION_SIMD_H
+
+#include "bytecode.hpp"
+#include <string>
+
+
+class SimdEvaluator
+{
+public:
+    enum Isa
+    {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    // Deepest value (and condition) stack the vector kernels support
+    static constexpr int MAX_STACK = 64;
+
+    SimdEvaluator ();
+
+    bool load  (const Bytecode& _bytecode);
+    void clear ();
+
+    // y[i] = f(x[i]) for i = [0, count)
+    void eval (const double* x, double* y, int count) const;
+
+    // Largest relative difference between the vector kernels and the scalar reference
+    double maxDeviation (const double* x, int count) const;
+
+    // Falls back to the best supported set if "_isa" is not supported by the CPU
+    void setIsa (Isa _isa);
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline       bool         isLoaded () const;
+    inline       Isa          getIsa   () const;
+    inline const std::string& getError () const;
+
+    static Isa detectIsa ();
+    static const char* getIsaName (Isa _isa);
+
+private:
+    void evalIsa (Isa _isa, const double* x, double* y, int count) const;
+
+    Bytecode bytecode;
+    Isa isa;
+    std::string error; // why the last load() failed
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline       bool                 SimdEvaluator::isLoaded () const { return !bytecode.empty(); }
+inline       SimdEvaluator::Isa   SimdEvaluator::getIsa   () const { return isa;               }
+inline const std::string&         SimdEvaluator::getError () const { return error;             }
+
+
+#endif /* EXPRESSION_SIMD_H */
@@ -0,0 +1,380 @@
+/*
+ *
+ * SIMD kernels
+ * Instruction-set independent part of the SimdEvaluator
+ *
+ * Every kernel is a template over a vector type V providing the primitive
+ * operations (see VecSSE2 and VecAVX2). Each instruction set instantiates
+ * the kernels in its own translation unit, compiled with its own flags.
+ *
+ * The polynomial approximations are the ones of the Cephes Math Library
+ * (Stephen L. Moshier, http://www.netlib.org/cephes/)
+ *
+ */
+
+#ifndef EXPRESSION_SIMD_KERNELS_H
+#define EXPRESSION_SIMD_KERNELS_H
+
+#include "bytecode.hpp"
+#include <cmath>
+
+// Entry points, one per instruction set
+void simd_eval_sse2 (const Bytecode::Instruction* code, int size, const double* x, double* y, int count);
+void simd_eval_avx2 (const Bytecode::Instruction* code, int size, const double* x, double* y, int count);
+
+
+template<class V>
+struct SimdKernel
+{
+    typedef typename V::type T;
+
+    static constexpr int    MAX_STACK = 64;
+    static constexpr double LOG2E     = 1.4426950408889634073599;
+    static constexpr double LOG10E    = 0.43429448190325182765;
+    static constexpr double SQRTH     = 0.70710678118654752440;
+    static constexpr double FOPI      = 1.27323954473516268615; // 4/pi
+    static constexpr double SIN_LIMIT = 1073741824.0;           // past 2^30 the reduction below loses accuracy
+
+    static T mask_to_bool (T mask) { return V::and_(mask, V::set1(1.0)); }
+
+    // 2^n for an integral n in [-1022, 1023]
+    static T pow2n (T n)
+    {
+        const T biased = V::add(n, V::set1(1023.0 + 6755399441055744.0)); // 1.5 * 2^52 puts the integer in the low bits
+        return V::shl52(biased);
+    }
+
+    /*
+     *
+     * exp
+     *
+     */
+
+    static T exp (T x)
+    {
+        const T hi = V::set1( 709.78271289338397);
+        const T lo = V::set1(-708.39641853226408);
+
+        const T nan   = V::neq(x, x);
+        const T over  = V::gt(x, hi);
+        const T under = V::lt(x, lo);
+
+        T xc = V::min(V::max(x, lo), hi);
+
+        // x = n * ln2 + r, |r| <= ln2 / 2
+        const T n = V::floor(V::add(V::mul(xc, V::set1(LOG2E)), V::set1(0.5)));
+        xc = V::sub(xc, V::mul(n, V::set1(6.93145751953125E-1)));
+        xc = V::sub(xc, V::mul(n, V::set1(1.42860682030941723212E-6)));
+
+        const T xx = V::mul(xc, xc);
+
+        T px = V::set1(1.26177193074810590878E-4);
+        px = V::add(V::mul(px, xx), V::set1(3.02994407707441961300E-2));
+        px = V::add(V::mul(px, xx), V::set1(9.99999999999999999910E-1));
+        px = V::mul(px, xc);
+
+        T qx = V::set1(3.00198505138664455042E-6);
+        qx = V::add(V::mul(qx, xx), V::set1(2.52448340349684104192E-3));
+        qx = V::add(V::mul(qx, xx), V::set1(2.27265548208155028766E-1));
+        qx = V::add(V::mul(qx, xx), V::set1(2.00000000000000000009E0));
+
+        T e = V::div(px, V::sub(qx, px));
+        e = V::add(V::set1(1.0), V::add(e, e));
+
+        // scale in two steps, 2^1024 is not representable
+        const T n1 = V::floor(V::mul(n, V::set1(0.5)));
+        const T n2 = V::sub(n, n1);
+        e = V::mul(V::mul(e, pow2n(n1)), pow2n(n2));
+
+        e = V::blend(over,  V::set1(HUGE_VAL), e);
+        e = V::blend(under, V::set1(0.0),      e);
+        return V::blend(nan, x, e);
+    }
+
+    /*
+     *
+     * log
+     *
+     */
+
+    static T log (T x)
+    {
+        const T tiny = V::lt(x, V::set1(2.2250738585072014e-308)); // denormals are scaled up first
+
+        T xs = V::blend(tiny, V::mul(x, V::set1(18014398509481984.0)), x); // 2^54
+        T e  = V::sub(V::exponent(xs), V::set1(1022.0));
+        e = V::sub(e, V::and_(tiny, V::set1(54.0)));
+
+        // x = m * 2^e, m = [0.5, 1)
+        T m = V::mantissa(xs);
+
+        const T low = V::lt(m, V::set1(SQRTH));
+        e = V::sub(e, V::and_(low, V::set1(1.0)));
+        m = V::blend(low, V::sub(V::add(m, m), V::set1(1.0)), V::sub(m, V::set1(1.0)));
+
+        const T z = V::mul(m, m);
+
+        T p = V::set1(1.01875663804580931796E-4);
+        p = V::add(V::mul(p, m), V::set1(4.97494994976747001425E-1));
+        p = V::add(V::mul(p, m), V::set1(4.70579119878881725854E0));
+        p = V::add(V::mul(p, m), V::set1(1.44989225341610930846E1));
+        p = V::add(V::mul(p, m), V::set1(1.79368678507819816313E1));
+        p = V::add(V::mul(p, m), V::set1(7.70838733755885391666E0));
+
+        T q = V::add(m, V::set1(1.12873587189167450590E1));
+        q = V::add(V::mul(q, m), V::set1(4.52279145837532221105E1));
+        q = V::add(V::mul(q, m), V::set1(8.29875266912776603211E1));
+        q = V::add(V::mul(q, m), V::set1(7.11544750618563894466E1));
+        q = V::add(V::mul(q, m), V::set1(2.31251620126765340583E1));
+
+        T y = V::mul(m, V::div(V::mul(z, p), q));
+        y = V::sub(y, V::mul(e, V::set1(2.121944400546905827679e-4)));
+        y = V::sub(y, V::mul(z, V::set1(0.5)));
+
+        T r = V::add(V::add(m, y), V::mul(e, V::set1(0.693359375)));
+
+        r = V::blend(V::eq(x, V::set1(HUGE_VAL)), x,                   r);
+        r = V::blend(V::eq(x, V::set1(0.0)),      V::set1(-HUGE_VAL),  r);
+        r = V::blend(V::lt(x, V::set1(0.0)),      V::set1(NAN),        r);
+        return V::blend(V::neq(x, x), x, r);
+    }
+
+    /*
+     *
+     * sin, cos
+     *
+     */
+
+    // Reduces |x| to z = [-pi/4, pi/4], "octant" is the even octant index (mod 8)
+    static T reduce (T ax, T& octant)
+    {
+        T j = V::floor(V::mul(ax, V::set1(FOPI)));
+
+        // make j even
+        const T half = V::mul(j, V::set1(0.5));
+        const T odd  = V::neq(half, V::floor(half));
+        j = V::add(j, V::and_(odd, V::set1(1.0)));
+
+        octant = V::sub(j, V::mul(V::set1(8.0), V::floor(V::mul(j, V::set1(0.125)))));
+
+        T z = V::sub(ax, V::mul(j, V::set1(7.85398125648498535156E-1)));
+        z = V::sub(z, V::mul(j, V::set1(3.77489470793079817668E-8)));
+        return V::sub(z, V::mul(j, V::set1(2.69515142907905952645E-15)));
+    }
+
+    static T sin_poly (T z, T zz)
+    {
+        T p = V::set1(1.58962301576546568060E-10);
+        p = V::add(V::mul(p, zz), V::set1(-2.50507477628578072866E-8));
+        p = V::add(V::mul(p, zz), V::set1(2.75573136213857245213E-6));
+        p = V::add(V::mul(p, zz), V::set1(-1.98412698295895385996E-4));
+        p = V::add(V::mul(p, zz), V::set1(8.33333333332211858878E-3));
+        p = V::add(V::mul(p, zz), V::set1(-1.66666666666666307295E-1));
+        return V::add(z, V::mul(z, V::mul(zz, p)));
+    }
+
+    static T cos_poly (T zz)
+    {
+        T p = V::set1(-1.13585365213876817300E-11);
+        p = V::add(V::mul(p, zz), V::set1(2.08757008419747316778E-9));
+        p = V::add(V::mul(p, zz), V::set1(-2.75573141792967388112E-7));
+        p = V::add(V::mul(p, zz), V::set1(2.48015872888517045348E-5));
+        p = V::add(V::mul(p, zz), V::set1(-1.38888888888730564116E-3));
+        p = V::add(V::mul(p, zz), V::set1(4.16666666666665929218E-2));
+        return V::add(V::sub(V::set1(1.0), V::mul(zz, V::set1(0.5))), V::mul(V::mul(zz, zz), p));
+    }
+
+    static T sin (T x)
+    {
+        const T ax = V::abs(x);
+
+        T octant;
+        const T z  = reduce(ax, octant);
+        const T zz = V::mul(z, z);
+
+        const T upper = V::ge(octant, V::set1(4.0));
+        octant = V::sub(octant, V::and_(upper, V::set1(4.0)));
+
+        const T useCos = V::eq(octant, V::set1(2.0));
+        T y = V::blend(useCos, cos_poly(zz), sin_poly(z, zz));
+
+        // sign of x, flipped in the upper half of the circle
+        const T negative = V::xor_(V::lt(x, V::set1(0.0)), upper);
+        return V::blend(negative, V::neg(y), y);
+    }
+
+    static T cos (T x)
+    {
+        const T ax = V::abs(x);
+
+        T octant;
+        const T z  = reduce(ax, octant);
+        const T zz = V::mul(z, z);
+
+        const T upper = V::ge(octant, V::set1(4.0));
+        octant = V::sub(octant, V::and_(upper, V::set1(4.0)));
+
+        const T useSin = V::eq(octant, V::set1(2.0));
+        T y = V::blend(useSin, sin_poly(z, zz), cos_poly(zz));
+
+        const T negative = V::xor_(upper, useSin);
+        return V::blend(negative, V::neg(y), y);
+    }
+
+    /*
+     *
+     * Helpers
+     *
+     */
+
+    typedef double (*Scalar1) (double);
+    typedef double (*Scalar2) (double, double);
+
+    static T per_lane (T a, Scalar1 fn)
+    {
+        alignas(32) double la[V::LANES];
+        V::store(la, a);
+        for(int i = 0; i < V::LANES; i++)
+            la[i] = fn(la[i]);
+        return V::load(la);
+    }
+
+    static T per_lane (T a, T b, Scalar2 fn)
+    {
+        alignas(32) double la[V::LANES];
+        alignas(32) double lb[V::LANES];
+        V::store(la, a);
+        V::store(lb, b);
+        for(int i = 0; i < V::LANES; i++)
+            la[i] = fn(la[i], lb[i]);
+        return V::load(la);
+    }
+
+    // The reductions of sin/cos only hold for finite |x| < SIN_LIMIT
+    static bool needs_scalar_trig (T x)
+    {
+        return V::any(V::nle(V::abs(x), V::set1(SIN_LIMIT)));
+    }
+
+    static T call1 (const Bytecode::Instruction& ins, T a)
+    {
+        switch(ins.func)
+        {
+        case Bytecode::Plus:  return a;
+        case Bytecode::Neg:   return V::neg(a);
+        case Bytecode::Abs:   return V::abs(a);
+        case Bytecode::Sqrt:  return V::sqrt(a);
+        case Bytecode::Exp:   return exp(a);
+        case Bytecode::Log:   return log(a);
+        case Bytecode::Log2:  return V::mul(log(a), V::set1(LOG2E));
+        case Bytecode::Log10: return V::mul(log(a), V::set1(LOG10E));
+        case Bytecode::Sign:
+            return V::sub(V::and_(V::gt(a, V::set1(0.0)), V::set1(1.0)),
+                          V::and_(V::lt(a, V::set1(0.0)), V::set1(1.0)));
+        case Bytecode::Sin:
+            return needs_scalar_trig(a) ? per_lane(a, ins.fn1) : sin(a);
+        case Bytecode::Cos:
+            return needs_scalar_trig(a) ? per_lane(a, ins.fn1) : cos(a);
+        case Bytecode::Tan:
+            return needs_scalar_trig(a) ? per_lane(a, ins.fn1) : V::div(sin(a), cos(a));
+        default:
+            return per_lane(a, ins.fn1);
+        }
+    }
+
+    /*
+     *
+     * Interpreter
+     *
+     */
+
+    // Evaluates V::LANES abscissae, both branches of every if-then-else are evaluated
+    static T run (const Bytecode::Instruction* code, int size, T x)
+    {
+        T stack[MAX_STACK];
+        T masks[MAX_STACK];
+        T temps[Bytecode::MAX_TEMPS];
+        int top = -1;
+        int mtop = -1;
+
+        for(int i = 0; i < size; i++)
+        {
+            const Bytecode::Instruction& ins = code[i];
+            switch(ins.op)
+            {
+            case Bytecode::Const: stack[++top] = V::set1(ins.value); break;
+            case Bytecode::X:     stack[++top] = x;                  break;
+            case Bytecode::Var:   stack[++top] = V::set1(*ins.var);  break;
+            case Bytecode::Load:  stack[++top] = temps[ins.slot];    break;
+            case Bytecode::Store: temps[ins.slot] = stack[top];      break;
+
+            case Bytecode::Add: top--; stack[top] = V::add(stack[top], stack[top + 1]); break;
+            case Bytecode::Sub: top--; stack[top] = V::sub(stack[top], stack[top + 1]); break;
+            case Bytecode::Mul: top--; stack[top] = V::mul(stack[top], stack[top + 1]); break;
+            case Bytecode::Div: top--; stack[top] = V::div(stack[top], stack[top + 1]); break;
+
+            case Bytecode::LT:  top--; stack[top] = mask_to_bool(V::lt (stack[top], stack[top + 1])); break;
+            case Bytecode::LE:  top--; stack[top] = mask_to_bool(V::le (stack[top], stack[top + 1])); break;
+            case Bytecode::GT:  top--; stack[top] = mask_to_bool(V::gt (stack[top], stack[top + 1])); break;
+            case Bytecode::GE:  top--; stack[top] = mask_to_bool(V::ge (stack[top], stack[top + 1])); break;
+            case Bytecode::EQ:  top--; stack[top] = mask_to_bool(V::eq (stack[top], stack[top + 1])); break;
+            case Bytecode::NEQ: top--; stack[top] = mask_to_bool(V::neq(stack[top], stack[top + 1])); break;
+
+            case Bytecode::And:
+            case Bytecode::Or:
+            {
+                top--;
+                const T a = V::neq(stack[top],     V::set1(0.0));
+                const T b = V::neq(stack[top + 1], V::set1(0.0));
+                stack[top] = mask_to_bool(ins.op == Bytecode::And ? V::and_(a, b) : V::or_(a, b));
+                break;
+            }
+
+            case Bytecode::Pow:
+            case Bytecode::Call2:
+                top--;
+                stack[top] = per_lane(stack[top], stack[top + 1], ins.fn2);
+                break;
+
+            case Bytecode::Call1:
+                stack[top] = call1(ins, stack[top]);
+                break;
+
+            case Bytecode::If: // NaN counts as true, as in muParser
+                masks[++mtop] = V::neq(stack[top--], V::set1(0.0));
+                break;
+            case Bytecode::Else:
+                break;
+            case Bytecode::EndIf:
+                top--;
+                stack[top] = V::blend(masks[mtop--], stack[top], stack[top + 1]);
+                break;
+            }
+        }
+
+        return stack[0];
+    }
+
+    static void eval (const Bytecode::Instruction* code, int size, const double* x, double* y, int count)
+    {
+        int i = 0;
+        for(; i + V::LANES <= count; i += V::LANES)
+            V::storeu(y + i, run(code, size, V::loadu(x + i)));
+
+        if(i < count)
+        {
+            alignas(32) double lx[V::LANES];
+            alignas(32) double ly[V::LANES];
+            for(int l = 0; l < V::LANES; l++)
+                lx[l] = x[i + (l < count - i ? l : count - i - 1)];
+
+            V::store(ly, run(code, size, V::load(lx)));
+
+            for(int l = 0; i + l < count; l++)
+                y[i + l] = ly[l];
+        }
+    }
+};
+
+
+#endif /* EXPRESSION_SIMD_KERNELS_H */
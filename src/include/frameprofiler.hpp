@@ -0,0 +1,105 @@
+/*
+ *
+ * FrameProfiler
+ * GPU and CPU time of every render stage of a frame
+ *
+ * Each stage is bracketed by a pair of GL_TIMESTAMP queries, and by
+ * steady_clock readings on the CPU side (the time spent issuing it).
+ * The queries of a frame are read back FRAMES_IN_FLIGHT frames later, by
+ * which time the GPU is done with them, so reading never stalls the pipeline;
+ * a result that is still not available is skipped instead of waited for.
+ * Without timer queries (OpenGL < 3.3) only the CPU times are measured.
+ *
+ */
+
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include <glad/glad.h>
+#include <chrono>
+#include <vector>
+
+
+class FrameProfiler
+{
+public:
+    static constexpr int   FRAMES_IN_FLIGHT = 3;     // sets of queries
+    static constexpr int   HISTORY          = 1024;  // frames kept for save()
+    static constexpr float SMOOTHING        = 0.05f; // weight of the newest frame in the averages
+
+    enum Stage
+    {
+        Grid,      // background grid
+        Axes,
+        Ticks,     // tick lines
+        Labels,    // tick labels
+        Curves,    // the function strips
+        Interface, // ImGui
+        DebugText,
+        STAGE_COUNT
+    };
+
+    FrameProfiler ();
+    void destroy ();
+
+    // Reads the oldest set of queries back and starts a frame in it
+    void beginFrame ();
+
+    void begin (Stage stage);
+    void end   (Stage stage);
+
+    // Writes the per-stage times of the last HISTORY frames as CSV, returns false if the file cannot be written
+    bool save (const char* path) const;
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline bool      hasTimerQueries () const;
+    inline float     getGpuTime      (Stage stage) const; // ms, averaged
+    inline float     getCpuTime      (Stage stage) const; // ms, averaged
+    inline long long getFrames       () const;            // frames read back
+
+    static const char* getStageName (Stage stage);
+
+private:
+    // Times of a frame in ms, a negative GPU time was not measured
+    struct Sample
+    {
+        long long frame;
+        float gpu[STAGE_COUNT];
+        float cpu[STAGE_COUNT];
+    };
+
+    void collect (int set);
+
+    bool timerQueries = false;
+    GLuint queries[FRAMES_IN_FLIGHT][STAGE_COUNT][2] = {}; // begin and end timestamps
+    bool issued[FRAMES_IN_FLIGHT][STAGE_COUNT] = {};
+    float cpuTimes[FRAMES_IN_FLIGHT][STAGE_COUNT] = {};
+    std::chrono::steady_clock::time_point cpuBegin[STAGE_COUNT];
+    int current = -1; // set of the frame being recorded
+
+    float gpuAverage[STAGE_COUNT] = {};
+    float cpuAverage[STAGE_COUNT] = {};
+    long long frames = 0;
+
+    std::vector<Sample> history; // ring of HISTORY frames, the next one goes to frames % HISTORY
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline bool      FrameProfiler::hasTimerQueries ()            const { return timerQueries;      }
+inline float     FrameProfiler::getGpuTime      (Stage stage) const { return gpuAverage[stage]; }
+inline float     FrameProfiler::getCpuTime      (Stage stage) const { return cpuAverage[stage]; }
+inline long long FrameProfiler::getFrames       ()            const { return frames;            }
+
+
+#endif /* FRAMEPROFILER_H */
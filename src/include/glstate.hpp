@@ -0,0 +1,69 @@
+/*
+ *
+ * GLState
+ * Cache of the GL bindings, skips the calls that would not change them
+ *
+ * Every bind of the program, the VAO, the GL_ARRAY_BUFFER and the 2D textures
+ * goes through here, so the cache always matches the context; the ImGui
+ * backend restores the bindings it changes before it returns. The element
+ * array buffer binding belongs to the VAO and is not cached. Objects must be
+ * released before they are deleted, GL unbinds them and their name may be
+ * reused by the next object generated.
+ *
+ */
+
+#ifndef GLSTATE_H
+#define GLSTATE_H
+
+#include <glad/glad.h>
+
+
+class GLState
+{
+public:
+    static constexpr int MAX_TEXTURE_UNITS = 16;
+
+    static void useProgram      (GLuint program);
+    static void bindVertexArray (GLuint VAO);
+    static void bindArrayBuffer (GLuint VBO);
+    static void bindTexture2D   (GLuint unit, GLuint texture); // makes the unit active
+
+    static void releaseProgram     (GLuint program);
+    static void releaseVertexArray (GLuint VAO);
+    static void releaseBuffer      (GLuint buffer);
+    static void releaseTexture     (GLuint texture);
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    static inline long long getIssued  (); // binds passed on to GL
+    static inline long long getSkipped (); // redundant binds
+
+private:
+    static constexpr GLuint UNKNOWN = ~0u;
+
+    static GLuint program;
+    static GLuint vertexArray;
+    static GLuint arrayBuffer;
+    static GLuint activeUnit;
+    static GLuint textures[MAX_TEXTURE_UNITS];
+
+    static long long issued;
+    static long long skipped;
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline long long GLState::getIssued  () { return issued;  }
+inline long long GLState::getSkipped () { return skipped; }
+
+
+#endif /* GLSTATE_H */
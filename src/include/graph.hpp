@@ -12,18 +12,50 @@
 #include "shader.hpp"
 #include "line.hpp"
 #include "textrenderer/textrenderer.hpp"
-#include "muParser/muParser.h"
+#include "sampler.hpp"
+#include "adaptivesampler.hpp"
+#include "ringcontainer.hpp"
+#include "streamcontainer.hpp"
+#include "tilecache.hpp"
+#include "asyncsampler.hpp"
+#include "implicitsampler.hpp"
+#include "curvesampler.hpp"
+#include "frameprofiler.hpp"
 #include <glm/glm.hpp>
 #include <imgui.h>
+#include <string>
+#include <vector>
 
 
 class Graph : public Object
 {
 public:
+    enum Sampling
+    {
+        Uniform,  // every "step" over the range, evaluated in the background
+        Adaptive, // refined until the curve is within a pixel tolerance, see AdaptiveSampler
+        Viewport, // about one sample per pixel column over the visible part of the X axis, cached in tiles
+        Implicit,   // the curves f(x, y) = 0 over the visible area, see ImplicitSampler
+        Parametric, // the curves (x(t), y(t)) sampled by arc length, see CurveSampler
+        Polar       // the curves r(t) sampled by arc length, see CurveSampler
+    };
+
+    // Share of the visible width sampled past each screen edge in Viewport and Implicit modes,
+    // and of the visible height refined past each edge in Adaptive and Implicit modes
+    static constexpr double VIEW_MARGIN = 0.25;
+
+    // Functions plotted at once, the size of the curve uniform arrays of shaders/graph.vs
+    static constexpr int MAX_CURVES = 64;
+
+    // Closest the minor grid lines get on screen before the next power of ten takes over
+    static constexpr double GRID_MIN_PIXELS = 8.0;
+
     // scalar constructor
     Graph(Shader& shader,
           Shader& _graphShader,
           Shader& _glyphShader,
+          Shader& _tickShader,
+          Shader& _gridShader,
           const Camera& camera,
           float posX, float posY,
           float szX, float szY,
@@ -33,6 +65,8 @@ public:
 
     void updateLines ();
     void updateVertices ();
+    void updateView (); // like updateVertices(), but a pan in Viewport mode only evaluates the newly exposed samples
+    bool pollVertices (); // to be called every frame, returns true if new Uniform samples were swapped in
     void updateRange (int _range);
     void render (const TextRenderer& textRenderer, GLuint fontID, float colorR, float colorG, float colorB, float alpha);
     void render (const TextRenderer& textRenderer, GLuint fontID, const ImVec4& color);
@@ -45,8 +79,30 @@ public:
      *
      */
 
-    inline void setFunction (const char* func);
-    inline void testFunction ();
+    inline void setFunction  (const char* func);
+           void setFunctions (const std::vector<std::string>& funcs); // at most MAX_CURVES, of the current mode
+           void testFunction ();
+    inline void setColor     (int curve, const glm::vec3& color);
+    inline void setEngine   (Sampler::Engine engine);
+    inline void setSimdIsa  (SimdEvaluator::Isa isa);
+    inline void setDerivative (int order); // 0 - f, 1 - f', 2 - f'' of the Uniform, Adaptive and Viewport modes
+
+    inline void setSampling  (Sampling _sampling);
+    inline void setTolerance (float tolerance);
+    inline void setParameterRange (double tMin, double tMax); // of the Parametric or Polar mode
+
+    inline void cancelSampling ();
+
+    inline void setProfiler (FrameProfiler* _profiler); // times the grid, axes, ticks, labels and curves stages of render()
+
+    // Background lines at powers of ten of the graph units, over the whole screen at any zoom
+    inline void setGrid (bool _grid);
+    inline bool hasGrid () const;
+
+    // Adaptive samples depend on the zoom they were taken at and on the visible range of f,
+    // Viewport samples on the zoom and the visible domain, Implicit ones on the zoom and the visible area,
+    // Parametric and Polar ones on the zoom. All of them are written against the camera's floating origin
+    bool isSamplingOutdated () const;
 
     /*
      *
@@ -66,39 +122,126 @@ public:
     inline       int        getRange        () const;
     inline       int        getLineCount    () const;
     inline       int        getPointsCount  () const;
-    inline       double     getX            () const;
     inline       double     getStep         () const;
-    inline       GLsizei    getLineBuffSize () const;
     inline const Shader&    getGraphShader  () const;
     inline const Shader&    getGlyphShader  () const;
-    inline const Object*    getLines        () const;
+    inline const Shader&    getTickShader   () const;
+    inline const Shader&    getGridShader   () const;
+    inline const Sampler&   getSampler      () const;
+    inline const Container& getTicks        () const;
+    inline const Container& getLabels       () const;
     inline const Object&    getAxisX        () const;
     inline const Object&    getAxisY        () const;
     inline const Container& getLineX        () const;
     inline const Container& getLineY        () const;
     inline       glm::vec2 getAxisSize      () const;
 
+    inline       Sampling         getSampling        () const;
+    inline const AdaptiveSampler& getAdaptiveSampler () const;
+    inline       double           getViewStep        () const;
+    inline       double           getViewStart       () const;
+    inline       int              getViewPointsCount () const;
+    inline const RingContainer&   getViewRing        () const;
+    inline const StreamContainer& getCurveStream     () const;
+    inline const StreamContainer& getUniformStream   () const;
+    inline const TileCache&       getTileCache       () const;
+    inline const ImplicitSampler& getImplicitSampler () const;
+    inline const CurveSampler&    getCurveSampler    () const; // of the Parametric or Polar mode
+    inline       double           getImplicitStep    () const;
+
+                 int                       getFunctionCount () const; // of the current mode
+           const std::vector<std::string>& getFunctions     () const;
+    inline const glm::vec3&                getColor         (int curve) const;
+
+    inline       bool               isSamplingBusy      () const;
+    inline       float              getSamplingProgress () const;
+    inline const std::string&       getSamplingError    () const;
+
 private:
     void initializeAxes ();
 
     void generateLineContainers ();
-    void updateLineBuffer ();
-    void updateGlyphModel (float posX, float posY);
+    void updateLabels (const TextRenderer& textRenderer, GLuint fontID);
+    void viewWindow (long long& first, GLsizei& count, double& _step) const;
+    void viewSpan   (double& left, double& right) const;
+    void viewBand   (double& bottom, double& top) const;
+    double cellStep () const; // of the Implicit grid at the current zoom
+    void writeView  (long long first, GLsizei count);
+    glm::dvec2 vertexOrigin () const; // of the graph, relative to the camera's floating origin
+    void useCurves  (const std::vector<GLint>& curveFirst); // binds the colors of the curves starting at those vertices
 
+    void renderGrid ();
     void renderLines(const TextRenderer& textRenderer, GLuint fontID, float colorR, float colorG, float colorB, float alpha);
 
     Shader& graphShader;
     Shader& glyphShader;
+    Shader& tickShader;
+    Shader& gridShader;
+
+    // resolved once, see Shader::getUniform()
+    UniformHandle curveCountUniform;
+    UniformHandle curveFirstUniform;
+    UniformHandle curveColorUniform;
+    UniformHandle shiftUniform;
+    UniformHandle glyphModelUniform;
+    UniformHandle translationUniform;
+    UniformHandle gridRatioUniform;
+    UniformHandle gridCenterUniform;
+    UniformHandle gridSpacingUniform;
+    UniformHandle gridFadeUniform;
+    FrameProfiler* profiler = nullptr;
 
     Container lineX;
     Container lineY;
     int lineCount;
-    GLint lineBuffSize = -1;
-    Object* lines = nullptr;
+
+    bool grid = false;
+    Container gridContainer; // only its VAO, shaders/grid.vs makes the triangle from gl_VertexID
+    Container ticks; // per-instance {offset.x, offset.y, scale.x, scale.y} of every tick, drawn by shaders/ticks.vs
+
+    // Glyph quads of every tick label relative to the graph position, laid out again only
+    // after updateLines() or when rendered with another font
+    Container labels;
+    std::vector<GLfloat> labelVertices;
+    bool labelsOutdated = true;
+    GLuint labelFont = 0;
 
     double step;
-    double X = 0.0;
-    mu::Parser parser;
+    Sampler sampler;
+    std::vector<glm::vec3> colors; // one per function
+    Sampling sampling = Uniform;
+    AdaptiveSampler adaptive;
+    float sampledZoom = 0.0f;
+    glm::dvec2 sampledOrigin = {0.0, 0.0}; // vertexOrigin() the vertices were written against
+    double sampledBottom = 0.0; // range of f refined by the last Adaptive pass, or of y contoured by the last Implicit one
+    double sampledTop = 0.0;
+
+    // Viewport mode, sample i is x = i * viewStep
+    RingContainer viewRing;
+    double viewStep = 0.0;
+    TileCache tileCache;
+    std::vector<double> viewValues;
+
+    // Implicit mode, the area [sampledLeft, sampledRight] x [sampledBottom, sampledTop] with implicitStep wide cells
+    ImplicitSampler implicit;
+    double implicitStep = 0.0;
+    double sampledLeft = 0.0;
+    double sampledRight = 0.0;
+
+    // Parametric and Polar modes, sampled at sampledZoom
+    CurveSampler parametric {CurveSampler::Parametric};
+    CurveSampler polar {CurveSampler::Polar};
+
+    // Adaptive, Implicit, Parametric and Polar vertices
+    StreamContainer curveStream;
+
+    // Uniform mode, the drawn region is kept while the next samples are written into another one
+    AsyncSampler background;
+    StreamContainer uniformStream;
+    int uniformPointsCount = 0; // per curve
+    int uniformCurves = 0;
+    glm::dvec2 uniformOrigin = {0.0, 0.0}; // sampledOrigin of the drawn region
+    std::string samplingError; // of the last background job
 
     int pointsCount;
 
@@ -122,8 +265,22 @@ inline void Graph::render (const TextRenderer& textRenderer, GLuint fontID, cons
  *
  */
 
-inline void Graph::testFunction ()                 { parser.Eval();        }
-inline void Graph::setFunction  (const char* func) { parser.SetExpr(func); }
+inline void Graph::setFunction  (const char* func) { setFunctions({func});        }
+inline void Graph::setColor     (int curve, const glm::vec3& color) { colors[curve] = color; }
+inline void Graph::setEngine    (Sampler::Engine engine) { sampler.setEngine(engine); tileCache.clear(); }
+inline void Graph::setSimdIsa   (SimdEvaluator::Isa isa) { sampler.setSimdIsa(isa); tileCache.clear(); }
+inline void Graph::setDerivative (int order)             { sampler.setDerivative(order); }
+
+inline void Graph::setSampling  (Sampling _sampling) { sampling = _sampling;             }
+inline void Graph::setTolerance (float tolerance)    { adaptive.setTolerance(tolerance); }
+inline void Graph::setParameterRange (double tMin, double tMax) { (sampling == Polar ? polar : parametric).setRange(tMin, tMax); }
+
+inline void Graph::cancelSampling () { background.cancel(); }
+
+inline void Graph::setProfiler (FrameProfiler* _profiler) { profiler = _profiler; }
+
+inline void Graph::setGrid (bool _grid) { grid = _grid; }
+inline bool Graph::hasGrid () const     { return grid;  }
 
 /*
  *
@@ -145,16 +302,37 @@ inline void Graph::setAxisSize (float sz)
 inline       int        Graph::getRange        () const { return range;        }
 inline       int        Graph::getLineCount    () const { return lineCount;    }
 inline       int        Graph::getPointsCount  () const { return pointsCount;  }
-inline       double     Graph::getX            () const { return X;            }
 inline       double     Graph::getStep         () const { return step;         }
-inline       GLsizei    Graph::getLineBuffSize () const { return lineBuffSize; }
 inline const Shader&    Graph::getGraphShader  () const { return graphShader;  }
 inline const Shader&    Graph::getGlyphShader  () const { return glyphShader;  }
-inline const Object*    Graph::getLines        () const { return lines;        }
+inline const Shader&    Graph::getTickShader   () const { return tickShader;   }
+inline const Shader&    Graph::getGridShader   () const { return gridShader;   }
+inline const Sampler&   Graph::getSampler      () const { return sampler;      }
+inline const Container& Graph::getTicks        () const { return ticks;        }
+inline const Container& Graph::getLabels       () const { return labels;       }
 inline const Object&    Graph::getAxisX        () const { return axisX;        }
 inline const Object&    Graph::getAxisY        () const { return axisY;        }
 inline const Container& Graph::getLineX        () const { return lineX;        }
 inline const Container& Graph::getLineY        () const { return lineY;        }
 inline       glm::vec2  Graph::getAxisSize     () const { return {axisX.size.x, axisY.size.y}; }
 
+inline       Graph::Sampling  Graph::getSampling        () const { return sampling;             }
+inline const AdaptiveSampler& Graph::getAdaptiveSampler () const { return adaptive;             }
+inline       double           Graph::getViewStep        () const { return viewStep;             }
+inline       double           Graph::getViewStart       () const { return viewRing.getFirst() * viewStep; }
+inline       int              Graph::getViewPointsCount () const { return viewRing.getCount();  }
+inline const RingContainer&   Graph::getViewRing        () const { return viewRing;             }
+inline const StreamContainer& Graph::getCurveStream     () const { return curveStream;          }
+inline const StreamContainer& Graph::getUniformStream   () const { return uniformStream;        }
+inline const TileCache&       Graph::getTileCache       () const { return tileCache;            }
+inline const ImplicitSampler& Graph::getImplicitSampler () const { return implicit;             }
+inline const CurveSampler&    Graph::getCurveSampler    () const { return (sampling == Polar) ? polar : parametric; }
+inline       double           Graph::getImplicitStep    () const { return implicitStep;         }
+
+inline const glm::vec3&       Graph::getColor         (int curve) const { return colors[curve]; }
+
+inline       bool               Graph::isSamplingBusy      () const { return background.isBusy();      }
+inline       float              Graph::getSamplingProgress () const { return background.getProgress(); }
+inline const std::string&       Graph::getSamplingError    () const { return samplingError;            }
+
 #endif /* GRAPH_H */
@@ -0,0 +1,179 @@
+/*
+ *
+ * ImplicitSampler
+ * Extracts the curves f(x, y) = 0 over a rectangle with marching squares
+ *
+ * The rectangle is covered by a grid of square cells aligned to multiples of
+ * the cell width, so the contours do not shimmer while the view pans.
+ * The grid is cut into tiles of TILE_CELLS x TILE_CELLS cells, which the
+ * threads take one at a time. Every thread owns a parser per function, bound
+ * to its own arrays of x and y, so the tiles are evaluated without any shared state.
+ *
+ * When the function has an interval form, a tile whose enclosure excludes zero
+ * holds no contour and is skipped, otherwise it is split in four down to blocks
+ * of BLOCK_CELLS x BLOCK_CELLS cells. The corners of the blocks left are evaluated
+ * in one bulk call per tile, then every cell whose corners change sign gets one
+ * or two segments. Saddle cells are resolved with the mean of their corners.
+ *
+ * "lhs = rhs" is accepted for "lhs - rhs".
+ *
+ */
+
+#ifndef IMPLICITSAMPLER_H
+#define IMPLICITSAMPLER_H
+
+#include "muParser/muParser.h"
+#include "expression/bytecode.hpp"
+#include "expression/interval.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+class ImplicitSampler
+{
+public:
+    static constexpr int   TILE_CELLS  = 64;   // cells per side of a tile, a power of two
+    static constexpr int   BLOCK_CELLS = 4;    // cells per side of the smallest culled block
+    static constexpr float CELL_PIXELS = 4.0f; // widest cell on screen, see Graph
+
+    ImplicitSampler (unsigned int _threadCount = 0); // 0 - one thread per hardware thread
+    ~ImplicitSampler ();
+
+    ImplicitSampler (const ImplicitSampler&) = delete;
+    ImplicitSampler& operator= (const ImplicitSampler&) = delete;
+
+    /*
+     *
+     * Function
+     *
+     */
+
+    void setFunction  (const char* func); // a single function
+    void setFunctions (const std::vector<std::string>& funcs);
+
+    /*
+     *
+     * Sampling
+     *
+     */
+
+    // Contours every f over [left, right] x [bottom, top] with "step" wide cells and writes
+    // two vertices {originX + x * ratioX, originY + y * ratioY} per segment, one curve after the other
+    void sample (double left, double right,
+                 double bottom, double top,
+                 double step,
+                 double originX, double originY,
+                 float ratioX, float ratioY);
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline       int                       getThreadCount   () const;
+    inline       int                       getFunctionCount () const;
+    inline const std::string&              getFunction      (int function = 0) const;
+    inline const std::vector<std::string>& getFunctions     () const;
+    inline       bool                      hasInterval      (int function = 0) const; // tiles can be culled
+    inline       int                       getPointsCount   () const; // vertices written by the last sample()
+    inline       int                       getTileCount     () const; // of all the curves
+    inline       int                       getCulled        () const; // blocks skipped by their enclosure
+    inline       long long                 getEvaluated     () const; // corners evaluated
+    inline const std::vector<float>&       getVertices      () const;
+    inline const std::vector<int>&         getCurveFirst    () const;
+
+private:
+    // Cells [i, i + width) x [j, j + height) of the grid
+    struct Block
+    {
+        long long i, j;
+        int width, height;
+    };
+
+    struct Worker
+    {
+        std::vector<std::unique_ptr<mu::Parser>> parsers; // one per function
+        std::vector<double> X, Y; // corners of the blocks of the current tile, bound to "x" and "y"
+        std::vector<double> F;
+        std::vector<Block> blocks;
+        std::vector<std::vector<float>> vertices; // segments found by this worker, per function
+        int culled = 0;
+        long long evaluated = 0;
+    };
+
+    // Lowered forms of a function
+    struct Program
+    {
+        Bytecode bytecode;
+        IntervalEvaluator interval;
+    };
+
+    struct Job
+    {
+        long long firstI, firstJ; // first cell of the grid
+        long long lastI, lastJ;   // one past the last cell
+        int tilesI, tilesJ;
+        int items;                // tiles of all the functions
+        double step;
+        double originX, originY;
+        float ratioX, ratioY;
+    };
+
+    void workerLoop (int index);
+    void work (Worker& worker);
+    void sampleTile (Worker& worker, int function, int tile);
+    void cull (Worker& worker, int function, long long i, long long j, int size);
+    void march (Worker& worker, int function, const Block& block, const double* F);
+    void bindParsers (Worker& worker);
+    void compile ();
+
+    std::vector<std::string> functions = {"x^2 + y^2 = 25"};
+    std::vector<std::unique_ptr<Program>> programs; // one per function
+    std::vector<std::unique_ptr<Worker>> workers;   // workers[0] runs on the calling thread
+    std::vector<std::thread> threads;               // threads[i] runs workers[i + 1]
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::exception_ptr error;
+    unsigned int generation = 0;
+    int pending = 0;
+    bool quit = false;
+    Job job = {};
+    std::atomic<int> next {0}; // next tile to be taken
+
+    std::vector<float> vertices;
+    std::vector<int> curveFirst; // first vertex of every function
+    int tileCount = 0;
+    int culled = 0;
+    long long evaluated = 0;
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline       int                       ImplicitSampler::getThreadCount   ()             const { return static_cast<int>(workers.size());       }
+inline       int                       ImplicitSampler::getFunctionCount ()             const { return static_cast<int>(functions.size());     }
+inline const std::string&              ImplicitSampler::getFunction      (int function) const { return functions[function];                    }
+inline const std::vector<std::string>& ImplicitSampler::getFunctions     ()             const { return functions;                              }
+inline       bool                      ImplicitSampler::hasInterval      (int function) const { return programs[function]->interval.isLoaded(); }
+inline       int                       ImplicitSampler::getPointsCount   ()             const { return static_cast<int>(vertices.size() / 2);  }
+inline       int                       ImplicitSampler::getTileCount     ()             const { return tileCount;                              }
+inline       int                       ImplicitSampler::getCulled        ()             const { return culled;                                 }
+inline       long long                 ImplicitSampler::getEvaluated     ()             const { return evaluated;                              }
+inline const std::vector<float>&       ImplicitSampler::getVertices      ()             const { return vertices;                               }
+inline const std::vector<int>&         ImplicitSampler::getCurveFirst    ()             const { return curveFirst;                             }
+
+
+#endif /* IMPLICITSAMPLER_H */
@@ -45,7 +45,10 @@ public:
     inline Container* getContainer () const;
 
 private:
+    glm::mat4 relativeModel () const; // to the camera's floating origin
+
     glm::mat4 model;
+    UniformHandle modelUniform; // of the shader
     Container* container;
     bool container_allocated = false;
 
@@ -0,0 +1,99 @@
+/*
+ *
+ * RingContainer
+ * Container holding a sliding window of line strip vertices
+ *
+ * Sample "index" lives in the vertex slot index mod capacity, so moving
+ * the window only rewrites (and re-uploads) the slots of the samples that
+ * entered it. Slot 0 is mirrored into the extra slot "capacity", which lets
+ * a wrapped window be drawn as two line strips that still join up.
+ * Several curves share the window, each one in a ring of capacity + 1 vertices
+ * of its own, and are all drawn by a single glMultiDrawArrays call.
+ *
+ */
+
+#ifndef RINGCONTAINER_H
+#define RINGCONTAINER_H
+
+#include "container.hpp"
+
+
+class RingContainer : public Container
+{
+public:
+    // Reallocates the buffers for "_capacity" vertices (x,y) per curve and empties the window
+    void reset (GLsizei _capacity, int _curves = 1);
+
+    // Moves the window to the samples [_first, _first + _count), _count <= capacity.
+    // The samples that were not in the previous window must be written afterwards
+    void setWindow (long long _first, GLsizei _count);
+
+    // Calls run(index, vertices, count) for every contiguous run of slots of "curve" holding
+    // the samples [index, index + count), then uploads the slots
+    template<class Run>
+    void write (int curve, long long index, GLsizei count, Run run);
+
+    // Draws the window of every curve with one glMultiDrawArrays call
+    void draw (GLenum mode) const;
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline GLsizei   getCapacity   () const;
+    inline int       getCurves     () const;
+    inline long long getFirst      () const;
+    inline GLsizei   getCount      () const;
+    inline GLint     getCurveFirst (int curve) const; // first vertex of the ring of "curve"
+
+    // Slot of the sample "index"
+    inline GLsizei slot (long long index) const;
+
+private:
+    void upload (int curve, GLsizei _slot, GLsizei _count);
+
+    GLsizei capacity = 0;
+    int curves = 0;
+    long long first = 0;
+    GLsizei count = 0;
+};
+
+
+template<class Run>
+void RingContainer::write (int curve, long long index, GLsizei _count, Run run)
+{
+    while(_count > 0)
+    {
+        const GLsizei begin  = slot(index);
+        const GLsizei length = (begin + _count > capacity) ? capacity - begin : _count;
+
+        run(index, getVertices() + (getCurveFirst(curve) + begin) * 2 /* x,y attributes */, length);
+        upload(curve, begin, length);
+
+        index  += length;
+        _count -= length;
+    }
+}
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline GLsizei   RingContainer::getCapacity   ()          const { return capacity;                  }
+inline int       RingContainer::getCurves     ()          const { return curves;                    }
+inline long long RingContainer::getFirst      ()          const { return first;                     }
+inline GLsizei   RingContainer::getCount      ()          const { return count;                     }
+inline GLint     RingContainer::getCurveFirst (int curve) const { return curve * (capacity + 1);    }
+
+inline GLsizei RingContainer::slot (long long index) const
+{
+    const long long s = index % capacity;
+    return static_cast<GLsizei>(s < 0 ? s + capacity : s);
+}
+
+
+#endif /* RINGCONTAINER_H */
@@ -0,0 +1,206 @@
+/*
+ *
+ * Sampler
+ * Evaluates the plotted functions over evenly spaced abscissae
+ *
+ * The domain is split into disjoint slices, one per thread.
+ * Every thread owns a parser per function, all bound to its own array of
+ * abscissae, so the slices are evaluated without any shared state.
+ * Every function is evaluated in the same pass over a bulk of abscissae,
+ * which are computed once for all of them.
+ *
+ * With the JIT engine the expression is compiled to native code once per
+ * setFunction() and shared by all threads. Expressions the JIT cannot
+ * compile fall back to the parsers.
+ * The SIMD engine runs the same bytecode over whole bulks of abscissae,
+ * several per instruction, see SimdEvaluator.
+ * Both engines run the bytecode after the Optimizer pass.
+ * Whatever the engine, the bytecode also gives enclosures of the function
+ * over whole intervals, see IntervalEvaluator, and its exact derivatives,
+ * see DualEvaluator. With a derivative order set, every sample and every
+ * evaluation gives f' or f'' in place of f, without parsing the derivative.
+ *
+ */
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "muParser/muParser.h"
+#include "expression/bytecode.hpp"
+#include "expression/dual.hpp"
+#include "expression/interval.hpp"
+#include "expression/jit.hpp"
+#include "expression/optimizer.hpp"
+#include "expression/simd.hpp"
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+class Sampler
+{
+public:
+    // Number of samples evaluated by a single bulk call of a parser
+    static constexpr int BULK_SIZE = 1 << 14;
+
+    // Smallest slice worth handing to another thread
+    static constexpr int MIN_SLICE = 1 << 12;
+
+    enum Engine
+    {
+        Interpreter, // muParser bulk mode
+        Jit,         // native code, see JitFunction
+        Simd         // vectorized interpreter, see SimdEvaluator
+    };
+
+    Sampler (unsigned int _threadCount = 0); // 0 - one thread per hardware thread
+    ~Sampler ();
+
+    Sampler (const Sampler&) = delete;
+    Sampler& operator= (const Sampler&) = delete;
+
+    /*
+     *
+     * Function
+     *
+     */
+
+    void setFunction  (const char* func); // a single function
+    void setFunctions (const std::vector<std::string>& funcs);
+    void testFunction ();
+
+    void setEngine (Engine _engine);
+    void setSimdIsa (SimdEvaluator::Isa isa);
+
+    void setDerivative (int order); // 0 - f, 1 - f', 2 - f''
+
+    /*
+     *
+     * Sampling
+     *
+     */
+
+    // Evaluates every function f for x = start + i * step, i = [0, count)
+    // and writes the vertex {originX + x * ratioX, originY + f(x) * ratioY} for each sample,
+    // the vertices of the function k start at vertices + k * stride * 2
+    void sample (float* vertices, int count, int stride,
+                 double start, double step,
+                 double originX, double originY,
+                 float ratioX, float ratioY);
+
+    // y[i] = f(x[i]) for arbitrary abscissae
+    void evaluate (const double* x, double* y, int count, int function = 0);
+
+    // s[i] = the slope at x[i] of what evaluate() gives, returns false if the function
+    // has no dual form or f'' is plotted already
+    bool evaluateSlope (const double* x, double* s, int count, int function = 0);
+
+    // Encloses f over [a, b], returns false if the function has no interval form
+    // or a derivative is plotted
+    bool enclose (double a, double b, Interval& y, int function = 0) const;
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline       int                       getThreadCount   () const;
+    inline       int                       getFunctionCount () const;
+    inline const std::string&              getFunction      (int function = 0) const;
+    inline const std::vector<std::string>& getFunctions     () const;
+    inline       Engine                    getEngine        () const;
+    inline       int                       getDerivative    () const;
+                 Engine                    getActiveEngine  (int function = 0) const; // the engine actually used for the function
+    inline const Bytecode&                 getBytecode      (int function = 0) const;
+    inline const Optimizer&                getOptimizer     (int function = 0) const;
+    inline const JitFunction&              getJit           (int function = 0) const;
+    inline const SimdEvaluator&            getSimd          (int function = 0) const;
+    inline const DualEvaluator&            getDual          (int function = 0) const;
+
+    static const char* getEngineName (Engine _engine);
+
+private:
+    struct Worker
+    {
+        std::vector<std::unique_ptr<mu::Parser>> parsers; // one per function
+        std::vector<double> X; // abscissae of the current bulk, bound to "x"
+        std::vector<double> Y; // ordinates of the current bulk
+    };
+
+    // Lowered forms of a function
+    struct Program
+    {
+        Bytecode bytecode;
+        Optimizer optimizer;
+        JitFunction jit;
+        SimdEvaluator simd;
+        IntervalEvaluator interval;
+        DualEvaluator dual;
+    };
+
+    struct Job
+    {
+        float* vertices;  // sample()
+        int stride;
+        const double* x;  // evaluate()
+        double* y;
+        int order;        // of the derivative written into y
+        int function;
+        int count;
+        int sliceSize;
+        double start;
+        double step;
+        double originX, originY;
+        float ratioX, ratioY;
+    };
+
+    void workerLoop  (int index);
+    void run (Job current);
+    void sampleSlice (Worker& worker, const Job& job, int index);
+    void evaluateSlice (Worker& worker, int function, int order, const double* x, double* y, int count);
+    void bindParsers (Worker& worker);
+    void compile ();
+
+    std::vector<std::string> functions = {"x^2"};
+    std::vector<std::unique_ptr<Program>> programs; // one per function
+    Engine engine = Interpreter;
+    int derivative = 0;
+    std::vector<std::unique_ptr<Worker>> workers; // workers[0] runs on the calling thread
+    std::vector<std::thread> threads;             // threads[i] runs workers[i + 1]
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::exception_ptr error;
+    unsigned int generation = 0;
+    int pending = 0;
+    bool quit = false;
+    Job job = {};
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline       int                       Sampler::getThreadCount   ()             const { return static_cast<int>(workers.size());   }
+inline       int                       Sampler::getFunctionCount ()             const { return static_cast<int>(functions.size()); }
+inline const std::string&              Sampler::getFunction      (int function) const { return functions[function];                }
+inline const std::vector<std::string>& Sampler::getFunctions     ()             const { return functions;                          }
+inline       Sampler::Engine           Sampler::getEngine        ()             const { return engine;                             }
+inline       int                       Sampler::getDerivative    ()             const { return derivative;                         }
+inline const Bytecode&                 Sampler::getBytecode      (int function) const { return programs[function]->bytecode;       }
+inline const Optimizer&                Sampler::getOptimizer     (int function) const { return programs[function]->optimizer;      }
+inline const JitFunction&              Sampler::getJit           (int function) const { return programs[function]->jit;            }
+inline const SimdEvaluator&            Sampler::getSimd          (int function) const { return programs[function]->simd;           }
+inline const DualEvaluator&            Sampler::getDual          (int function) const { return programs[function]->dual;           }
+
+
+#endif /* SAMPLER_H */
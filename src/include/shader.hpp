@@ -11,6 +11,15 @@
 #include <glad/glad.h>
 #include <GL/gl.h>
 #include <unordered_map>
+#include "glstate.hpp"
+
+// An active uniform of a linked program, found by reflection when it is linked
+struct UniformHandle
+{
+    GLint  location = -1;      // -1 - not active, setting it does nothing
+    GLenum type     = GL_NONE; // GL_FLOAT_VEC2, GL_FLOAT_MAT4, ...
+    GLint  size     = 0;       // elements of an array
+};
 
 class Shader
 {
@@ -28,7 +37,9 @@ public:
 	 *
 	 */
 
-    GLint getUniformLocation (const char* name);
+    const UniformHandle& getUniform (const std::string& name) const; // of an array without the "[0]"
+    inline GLint getUniformLocation (const std::string& name) const;
+    inline const std::unordered_map<std::string, UniformHandle>& getUniforms () const;
     inline GLuint getID () const;
     inline const std::string& getVertexPath () const;
     inline const std::string& getFragmentPath () const;
@@ -84,11 +95,56 @@ public:
     void setUniformMatrix3x4 (const char* name, GLsizei count, GLboolean transpose, const GLfloat *value);
     void setUniformMatrix4x3 (const char* name, GLsizei count, GLboolean transpose, const GLfloat *value);
 
+    // by handle, see getUniform()
+
+    void setUniform   (const UniformHandle& uniform, GLfloat v0);
+    void setUniform   (const UniformHandle& uniform, GLfloat v0, GLfloat v1);
+    void setUniform   (const UniformHandle& uniform, GLfloat v0, GLfloat v1, GLfloat v2);
+    void setUniform   (const UniformHandle& uniform, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+
+    void setUniform   (const UniformHandle& uniform, GLint v0);
+    void setUniform   (const UniformHandle& uniform, GLint v0, GLint v1);
+    void setUniform   (const UniformHandle& uniform, GLint v0, GLint v1, GLint v2);
+    void setUniform   (const UniformHandle& uniform, GLint v0, GLint v1, GLint v2, GLint v3);
+
+    void setUniform   (const UniformHandle& uniform, GLuint v0);
+    void setUniform   (const UniformHandle& uniform, GLuint v0, GLuint v1);
+    void setUniform   (const UniformHandle& uniform, GLuint v0, GLuint v1, GLuint v2);
+    void setUniform   (const UniformHandle& uniform, GLuint v0, GLuint v1, GLuint v2, GLuint v3);
+
+    void setUniform1v (const UniformHandle& uniform, GLsizei count, const GLfloat *value);
+    void setUniform2v (const UniformHandle& uniform, GLsizei count, const GLfloat *value);
+    void setUniform3v (const UniformHandle& uniform, GLsizei count, const GLfloat *value);
+    void setUniform4v (const UniformHandle& uniform, GLsizei count, const GLfloat *value);
+
+    void setUniform1v (const UniformHandle& uniform, GLsizei count, const GLint *value);
+    void setUniform2v (const UniformHandle& uniform, GLsizei count, const GLint *value);
+    void setUniform3v (const UniformHandle& uniform, GLsizei count, const GLint *value);
+    void setUniform4v (const UniformHandle& uniform, GLsizei count, const GLint *value);
+
+    void setUniform1v (const UniformHandle& uniform, GLsizei count, const GLuint *value);
+    void setUniform2v (const UniformHandle& uniform, GLsizei count, const GLuint *value);
+    void setUniform3v (const UniformHandle& uniform, GLsizei count, const GLuint *value);
+    void setUniform4v (const UniformHandle& uniform, GLsizei count, const GLuint *value);
+
+    void setUniformMatrix2   (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+    void setUniformMatrix3   (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+    void setUniformMatrix4   (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+
+    void setUniformMatrix2x3 (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+    void setUniformMatrix3x2 (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+    void setUniformMatrix2x4 (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+    void setUniformMatrix4x2 (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+    void setUniformMatrix3x4 (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+    void setUniformMatrix4x3 (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value);
+
     #pragma endregion
 
 private:
+    void reflectUniforms ();
+
     GLuint m_ID;
-	std::unordered_map<const char*, GLint> uniformLocations;
+    std::unordered_map<std::string, UniformHandle> uniforms;
 
     std::string vertexPath;
     std::string fragmentPath;
@@ -99,6 +155,8 @@ inline 		 GLuint       Shader::getID              () const { return m_ID;
 inline const std::string& Shader::getVertexPath      () const { return vertexPath;   }
 inline const std::string& Shader::getFragmentPath    () const { return fragmentPath; }
 inline const std::string& Shader::getGeometryPath    () const { return geometryPath; }
+inline       GLint        Shader::getUniformLocation (const std::string& name) const { return getUniform(name).location; }
+inline const std::unordered_map<std::string, UniformHandle>& Shader::getUniforms () const { return uniforms; }
 
 
 #endif /* SHADER_H */
@@ -0,0 +1,63 @@
+/*
+ *
+ * SpscQueue
+ * Lock-free queue between exactly one producer and one consumer thread
+ *
+ * The producer only writes "tail", the consumer only writes "head",
+ * each publishes its slot with a release store the other side acquires.
+ * N must be a power of two.
+ *
+ */
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+
+template<class T, unsigned int N>
+class SpscQueue
+{
+    static_assert(N != 0 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    // Producer side, moves "value" in. Returns false if the queue is full
+    bool push (T& value);
+
+    // Consumer side, moves the oldest value out. Returns false if the queue is empty
+    bool pop (T& value);
+
+private:
+    T slots[N];
+    alignas(64) std::atomic<unsigned int> head {0}; // next slot to pop
+    alignas(64) std::atomic<unsigned int> tail {0}; // next slot to push
+};
+
+
+template<class T, unsigned int N>
+bool SpscQueue<T, N>::push (T& value)
+{
+    const unsigned int t = tail.load(std::memory_order_relaxed);
+    if(t - head.load(std::memory_order_acquire) == N)
+        return false;
+
+    slots[t & (N - 1)] = std::move(value);
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+}
+
+template<class T, unsigned int N>
+bool SpscQueue<T, N>::pop (T& value)
+{
+    const unsigned int h = head.load(std::memory_order_relaxed);
+    if(h == tail.load(std::memory_order_acquire))
+        return false;
+
+    value = std::move(slots[h & (N - 1)]);
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+
+#endif /* SPSCQUEUE_H */
@@ -0,0 +1,83 @@
+/*
+ *
+ * StreamContainer
+ * Vertices (x,y) rewritten often, without stalling on the driver
+ *
+ * The buffer holds REGIONS regions of the same capacity. The vertices are
+ * written into the region after the drawn one and committed, which makes it the
+ * drawn one; a region is fenced after it is drawn and waited on before it is
+ * written again, by which time the GPU is almost always done with it.
+ * With buffer storage (OpenGL 4.4) the buffer is mapped persistently and the
+ * vertices are written straight into it, otherwise they are staged on the CPU
+ * and uploaded into the region on commit().
+ *
+ */
+
+#ifndef STREAMCONTAINER_H
+#define STREAMCONTAINER_H
+
+#include <glad/glad.h>
+#include <vector>
+#include "glstate.hpp"
+
+
+class StreamContainer
+{
+public:
+    static constexpr int REGIONS = 3;
+
+    void create ();
+    void destroy ();
+
+    // Memory for "count" floats in the next region, valid until commit(); grows every region if needed
+    GLfloat* map (GLsizei count);
+    void commit (); // makes the mapped vertices the drawn ones
+
+    void bind_VAO () const; // of the drawn region, its vertices start at 0
+    void fence ();          // to be called after the draw calls reading the drawn region
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline bool      isPersistent () const;
+    inline GLsizei   getCapacity  () const; // floats per region
+    inline GLsizei   getCount     () const; // floats drawn
+    inline int       getRegion    () const; // drawn
+    inline long long getWaits     () const; // maps that found the GPU still reading their region
+
+private:
+    void allocate (GLsizei _capacity);
+    void wait (int region);
+
+    bool persistent = false;
+    GLuint VBO = 0;
+    GLuint VAOs[REGIONS] = {};
+    GLsync fences[REGIONS] = {};
+
+    GLfloat* mapped = nullptr;      // the whole buffer, when persistent
+    std::vector<GLfloat> staging;   // the next region, otherwise
+    GLsizei capacity = 0;
+    GLsizei count = 0;
+    GLsizei mappedCount = 0;
+    int region = 0;
+    long long waits = 0;
+};
+
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline bool      StreamContainer::isPersistent () const { return persistent; }
+inline GLsizei   StreamContainer::getCapacity  () const { return capacity;   }
+inline GLsizei   StreamContainer::getCount     () const { return count;      }
+inline int       StreamContainer::getRegion    () const { return region;     }
+inline long long StreamContainer::getWaits     () const { return waits;      }
+
+
+#endif /* STREAMCONTAINER_H */
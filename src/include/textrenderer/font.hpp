@@ -16,17 +16,28 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 #include <string>
+#include <vector>
 #include <iostream>
 
+#include "../container.hpp"
+
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #define MIN_CHAR 32  // ' '
 #define MAX_CHAR 126 // '~'
 
+#define ATLAS_WIDTH   512 // the height grows until every glyph fits
+#define ATLAS_PADDING 1   // texels between the glyphs, so that linear filtering does not bleed
+
+#define FONT_PIXEL_SIZE 48 // of the metrics, and of the Bitmap glyphs
+#define SDF_PIXEL_SIZE  32 // of the Sdf glyphs, their metrics are scaled up to FONT_PIXEL_SIZE
+#define SDF_SPREAD      4  // pixels of distance around the outline, each glyph grows by it on every side
+
 struct Character
 {
-    unsigned int texID;   // ID handle of the glyph texture
+    glm::vec2    uvMin;   // top left of the glyph in the atlas
+    glm::vec2    uvMax;   // bottom right of the glyph in the atlas
     glm::ivec2   size;    // size of glyph
     glm::ivec2   bearing; // offset from baseline to left/top of glyph
     unsigned int advance; // offset to advance to next glyph
@@ -35,20 +46,43 @@ struct Character
 class Font
 {
 public:
+    enum Rendering
+    {
+        Bitmap, // coverage, sharp only near FONT_PIXEL_SIZE pixels per em, see shaders/glyph.fs
+        Sdf     // signed distance to the outline, sharp at any scale, see shaders/sdfglyph.fs
+    };
+
     Font() = default;
-    Font(const FT_Library& ft, const std::string& fontpath);
+    Font(const FT_Library& ft, const std::string& fontpath, Rendering _rendering = Bitmap);
 
-    void render (const std::string& text, float x, float y, float scaleX, float scaleY) const;
+    // Strings are batched, every string added since the last flush() is drawn by a single call
+    void add   (const std::string& text, float x, float y, float scaleX, float scaleY);
+    void flush ();
+
+    // Appends the 6 vertices <vec2 pos, vec2 tex> of every glyph of the string, for meshes drawn with draw()
+    void layout (std::vector<GLfloat>& vertices, const std::string& text, float x, float y, float scaleX, float scaleY) const;
+    void draw   (const Container& mesh) const; // its VAO must read layout() vertices
 
     glm::vec2 calcTextSize (const std::string& text, float scaleX, float scaleY) const;
 
     inline bool anyError () const;
+    inline Rendering getRendering () const;
+    inline GLuint getAtlas () const;
+    inline glm::ivec2 getAtlasSize () const;
 
 private:
     GLuint VBO;
     GLuint VAO;
+    GLuint atlas = 0; // every glyph, GL_RED
+    glm::ivec2 atlasSize = {0, 0};
+    Rendering rendering = Bitmap;
+    float metricScale = 1.0f; // FONT_PIXEL_SIZE pixels per glyph pixel
+    int margin = 0;           // glyph pixels around the outline, SDF_SPREAD of the Sdf glyphs
     bool anyerr = false;
     Character characters[MAX_CHAR - MIN_CHAR];
+
+    std::vector<GLfloat> batch; // 6 vertices <vec2 pos, vec2 tex> per glyph
+    GLsizei VBOsize = 0;        // floats
 };
 
 
@@ -57,5 +91,20 @@ inline bool Font::anyError () const
     return anyerr;
 }
 
+inline Font::Rendering Font::getRendering () const
+{
+    return rendering;
+}
+
+inline GLuint Font::getAtlas () const
+{
+    return atlas;
+}
+
+inline glm::ivec2 Font::getAtlasSize () const
+{
+    return atlasSize;
+}
+
 
 #endif /* TEXTRENDERER_FONT_H */
@@ -29,18 +29,28 @@ public:
     TextRenderer(Shader& _shader);
 
     void done ();
-    GLuint loadFont (const std::string& fontpath);
+    GLuint loadFont (const std::string& fontpath, Font::Rendering rendering = Font::Bitmap);
     glm::vec2 fontTextSize (GLuint _fontID, const std::string& text, float scaleX, float scaleY) const;
 
-    void render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, float colorR, float colorG, float colorB, float alpha) const;
-    inline void render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, const ImVec4& color) const;
-    inline void render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, const glm::vec4& color) const;
+    // Draws a single string, the strings batched with add() are drawn with it
+    void render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, float colorR, float colorG, float colorB, float alpha);
+    inline void render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, const ImVec4& color);
+    inline void render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, const glm::vec4& color);
+
+    // Batches a string of the font, flush() draws every string batched since the last one with a single call
+    void add   (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY);
+    void flush (GLuint _fontID, float colorR, float colorG, float colorB, float alpha);
+
+    // Cached text, laid out once into vertices that the caller uploads to a mesh and draws with render()
+    void layout (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, std::vector<GLfloat>& vertices) const;
+    void render (GLuint _fontID, const Container& mesh, float colorR, float colorG, float colorB, float alpha) const;
 
     inline bool anyError () const;
 
 private:
     FT_Library ft;
     Shader& shader;
+    UniformHandle textColor;
 
     GLuint fontID = 0;
     bool anyerr = false;
@@ -49,7 +59,7 @@ private:
 
 inline bool TextRenderer::anyError () const { return anyerr; }
 
-inline void TextRenderer::render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, const ImVec4& color)    const { render(_fontID, text, x, y, scaleX, scaleY, color.x, color.y, color.z, color.w); }
-inline void TextRenderer::render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, const glm::vec4& color) const { render(_fontID, text, x, y, scaleX, scaleY, color.x, color.y, color.z, color.w); }
+inline void TextRenderer::render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, const ImVec4& color)    { render(_fontID, text, x, y, scaleX, scaleY, color.x, color.y, color.z, color.w); }
+inline void TextRenderer::render (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, const glm::vec4& color) { render(_fontID, text, x, y, scaleX, scaleY, color.x, color.y, color.z, color.w); }
 
 #endif /* TEXTRENDERER_H */
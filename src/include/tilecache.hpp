@@ -0,0 +1,109 @@
+/*
+ *
+ * TileCache
+ * Sampled values of the function, kept across views
+ *
+ * The X axis is cut into tiles of TILE_SIZE samples at every power of two
+ * step: tile "index" of "level" holds f(x) for x = (index * TILE_SIZE + i) * 2^level.
+ * Tiles are keyed by (expression and derivative hash, level, index), so panning back,
+ * zooming back out or switching back to an earlier function reuses them.
+ * Once the cache outgrows its memory budget the least recently used tiles are dropped.
+ *
+ */
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include "sampler.hpp"
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+
+class TileCache
+{
+public:
+    static constexpr int TILE_SIZE = 1024; // samples per tile
+
+    TileCache (std::size_t _budget = 32 << 20); // bytes
+
+    // y[i] = f((first + i) * 2^level) for i = [0, count) where f is the given function of "sampler",
+    // the missing tiles are evaluated by "sampler"
+    void fetch (Sampler& sampler, int function, int level, long long first, int count, double* y);
+    void clear ();
+
+    void setBudget (std::size_t _budget);
+
+    /*
+     *
+     * Getters
+     *
+     */
+
+    inline std::size_t getBudget    () const;
+    inline std::size_t getMemory    () const; // bytes held by the tiles
+    inline int         getTileCount () const;
+    inline long long   getHits      () const;
+    inline long long   getMisses    () const;
+
+private:
+    struct Key
+    {
+        std::size_t function; // hash of the expression and of the derivative order
+        int level;
+        long long index;
+
+        inline bool operator== (const Key& other) const;
+    };
+
+    struct KeyHash
+    {
+        inline std::size_t operator() (const Key& key) const;
+    };
+
+    struct Tile
+    {
+        Key key;
+        std::vector<double> values;
+    };
+
+    void evict ();
+
+    std::size_t budget;
+    std::list<Tile> tiles; // most recently used first
+    std::unordered_map<Key, std::list<Tile>::iterator, KeyHash> index;
+
+    std::vector<double> missX, missY; // abscissae and values of the missing tiles
+    long long hits = 0;
+    long long misses = 0;
+};
+
+
+inline bool TileCache::Key::operator== (const Key& other) const
+{
+    return function == other.function && level == other.level && index == other.index;
+}
+
+inline std::size_t TileCache::KeyHash::operator() (const Key& key) const
+{
+    std::size_t h = key.function;
+    h ^= std::hash<int>()(key.level)       + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    h ^= std::hash<long long>()(key.index) + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+    return h;
+}
+
+/*
+ *
+ * Getters
+ *
+ */
+
+inline std::size_t TileCache::getBudget    () const { return budget;                                           }
+inline std::size_t TileCache::getMemory    () const { return tiles.size() * TILE_SIZE * sizeof(double);        }
+inline int         TileCache::getTileCount () const { return static_cast<int>(tiles.size());                   }
+inline long long   TileCache::getHits      () const { return hits;                                             }
+inline long long   TileCache::getMisses    () const { return misses;                                           }
+
+
+#endif /* TILECACHE_H */
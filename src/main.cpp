@@ -1,6 +1,8 @@
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <vector>
 #include <math.h>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -16,6 +18,7 @@
 #include "include/line.hpp"
 #include "include/muParser/muParser.h"
 #include "include/graph.hpp"
+#include "include/frameprofiler.hpp"
 #include "include/debug/ClassManager.hpp"
 
 #include <imgui_impl_glfw.h>
@@ -167,14 +170,17 @@ int main ()
 
     Shader shader("shaders/vs.glsl", "shaders/fs.glsl");
     Shader glyph_shader("shaders/glyph.vs", "shaders/glyph.fs");
-    Shader scaled_glyph_shader("shaders/scaledglyph.vs", "shaders/glyph.fs");
+    Shader scaled_glyph_shader("shaders/scaledglyph.vs", "shaders/sdfglyph.fs");
     Shader graph_shader("shaders/graph.vs", "shaders/graph.fs");
+    Shader tick_shader("shaders/ticks.vs", "shaders/fs.glsl");
+    Shader grid_shader("shaders/grid.vs", "shaders/grid.fs");
 
     shader.use();
     shader.setUniform("color", 1.0f, 0.0f, 0.0f);
-
-    graph_shader.use();
-    graph_shader.setUniform("color", 1.0f, 1.0f, 1.0f);
+    tick_shader.use();
+    tick_shader.setUniform("color", 1.0f, 0.0f, 0.0f);
+    grid_shader.use();
+    grid_shader.setUniform("color", 1.0f, 0.0f, 0.0f);
 
     glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(screenWidth), 0.0f, static_cast<float>(screenHeight));
     glyph_shader.use();
@@ -193,7 +199,7 @@ int main ()
 
     TextRenderer scaled_text(scaled_glyph_shader);
     if(scaled_text.anyError()) return -1;
-    GLuint scaled_font_arial = scaled_text.loadFont("fonts/arial.ttf");
+    GLuint scaled_font_arial = scaled_text.loadFont("fonts/arial.ttf", Font::Sdf); // follows the zoom
     scaled_text.done();
 
     /*
@@ -219,7 +225,6 @@ int main ()
 
     // graph color buffers
     float color_axis     [3] = {1.0f, 0.0f, 0.0f};          // red
-    float color_function [3] = {1.0f, 1.0f, 1.0f};          // white
     float color_glyph    [4] = {0.0f, 1.0f, 0.0f, 1.0f};    // green
 
     /*
@@ -230,7 +235,7 @@ int main ()
 
     Graph graph
     (
-        shader, graph_shader, scaled_glyph_shader,
+        shader, graph_shader, scaled_glyph_shader, tick_shader, grid_shader,
         camera,
         0.0f, 0.0f,
         100.0f, 100.0f,
@@ -238,11 +243,14 @@ int main ()
         PI_F / 100.0f
     );
 
+    FrameProfiler profiler;
+    graph.setProfiler(&profiler);
+
     GLuint uboProjection;
     glGenBuffers(1, &uboProjection);
     glBindBuffer(GL_UNIFORM_BUFFER, uboProjection);
-    glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), NULL, GL_STATIC_DRAW);
-    glBindBufferRange(GL_UNIFORM_BUFFER, 0, uboProjection, 0, sizeof(glm::mat4));
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(glm::mat4) + sizeof(glm::vec4), NULL, GL_STATIC_DRAW); // std140 pads the vec2 residual
+    glBindBufferRange(GL_UNIFORM_BUFFER, 0, uboProjection, 0, sizeof(glm::mat4) + sizeof(glm::vec4));
 
     /*
      *
@@ -282,6 +290,7 @@ int main ()
          */
 
         process_input(window);
+        profiler.beginFrame();
 
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
@@ -300,6 +309,11 @@ int main ()
         camera.updateProjectionMatrix(screenWidth, screenHeight);
         glBindBuffer(GL_UNIFORM_BUFFER, uboProjection);
         glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), glm::value_ptr(camera.getProjectionMatrix()));
+        glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::vec2), glm::value_ptr(camera.getResidual()));
+
+        graph.pollVertices();
+        if(graph.isSamplingOutdated())
+            graph.updateView();
 
         graph.render(scaled_text, scaled_font_arial, color_glyph[0], color_glyph[1], color_glyph[2], color_glyph[3]);
 
@@ -312,6 +326,12 @@ int main ()
 #ifdef GRAPH_DEBUG
         ImGui::Begin("Debug");
         ClassManager::ImGui_printClassData(graph);
+        ClassManager::ImGui_printClassData(profiler);
+        if(ImGui::Button("Export frame times"))
+        {
+            if(!profiler.save("frametimes.csv"))
+                std::cout << "ERROR: cannot write frametimes.csv" << std::endl;
+        }
         ImGui::Text(("Average " + str_ms + " ms/frame (" + str_fps + " FPS)").c_str());
         ImGui::Text(("Time elapsed: " + std::to_string(glfwGetTime() - startTime) + 's').c_str());
         ImGui::End();
@@ -336,17 +356,25 @@ int main ()
         ImGui::SameLine();
         ImGui::InputText("##range", range_str, IM_ARRAYSIZE(range_str));
 
-        static char func[128] = "x^2";
+        static char func[1024] = "x^2"; // one function per line
         ImGui::Text("Function");
         ImGui::SameLine();
-        ImGui::InputText("##function", func, IM_ARRAYSIZE(func));
+        ImGui::InputTextMultiline("##function", func, IM_ARRAYSIZE(func), ImVec2(0.0f, ImGui::GetTextLineHeight() * 4.0f));
 
         if(ImGui::Button("Submit"))
         {
+            std::vector<std::string> funcs;
+            std::istringstream lines(func);
+            for(std::string line; std::getline(lines, line); )
+            {
+                if(line.find_first_not_of(" \t\r") != std::string::npos)
+                    funcs.push_back(line);
+            }
+
             bool parsererr = false;
             try
             {
-                graph.setFunction(func);
+                graph.setFunctions(funcs);
                 graph.testFunction();
             }
             catch (mu::Parser::exception_type &e)
@@ -382,12 +410,105 @@ int main ()
             }
         }
 
-        ImGui::Text("Function");
+        if(graph.isSamplingBusy())
+        {
+            ImGui::ProgressBar(graph.getSamplingProgress(), ImVec2(-80.0f, 0.0f));
+            ImGui::SameLine();
+            if(ImGui::Button("Cancel"))
+                graph.cancelSampling();
+        }
+        else if(!graph.getSamplingError().empty())
+        {
+            ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%s", graph.getSamplingError().c_str());
+        }
+
+        static int engine = Sampler::Interpreter;
+        static const char* engines[] = {"Interpreter", "JIT", "SIMD"};
+        ImGui::Text("Engine  ");
+        ImGui::SameLine();
+        if(ImGui::Combo("##engine", &engine, engines, IM_ARRAYSIZE(engines)))
+        {
+            graph.setEngine(static_cast<Sampler::Engine>(engine));
+            graph.updateVertices();
+        }
+
+        static int sampling = Graph::Uniform;
+        static const char* samplings[] = {"Uniform", "Adaptive", "Viewport", "Implicit", "Parametric", "Polar"};
+        ImGui::Text("Sampling");
         ImGui::SameLine();
-        if(ImGui::ColorEdit3("Function Color", color_function, ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoLabel))
+        if(ImGui::Combo("##sampling", &sampling, samplings, IM_ARRAYSIZE(samplings)))
+        {
+            graph.setSampling(static_cast<Graph::Sampling>(sampling));
+            graph.updateVertices();
+        }
+
+        static bool grid = graph.hasGrid();
+        ImGui::Text("Grid    ");
+        ImGui::SameLine();
+        if(ImGui::Checkbox("##grid", &grid))
+            graph.setGrid(grid);
+
+        if(sampling == Graph::Uniform || sampling == Graph::Adaptive || sampling == Graph::Viewport)
+        {
+            static int derivative = 0;
+            static const char* derivatives[] = {"f", "f'", "f''"};
+            ImGui::Text("Plot    ");
+            ImGui::SameLine();
+            if(ImGui::Combo("##derivative", &derivative, derivatives, IM_ARRAYSIZE(derivatives)))
+            {
+                graph.setDerivative(derivative);
+                graph.updateVertices();
+            }
+        }
+
+        if(sampling == Graph::Adaptive)
+        {
+            static float tolerance = graph.getAdaptiveSampler().getTolerance();
+            ImGui::Text("Error   ");
+            ImGui::SameLine();
+            if(ImGui::SliderFloat("##tolerance", &tolerance, 0.05f, 4.0f, "%.2f px"))
+            {
+                graph.setTolerance(tolerance);
+                graph.updateVertices();
+            }
+        }
+
+        if(sampling == Graph::Parametric || sampling == Graph::Polar)
+        {
+            const CurveSampler& curves = graph.getCurveSampler();
+            float trange[2] = {static_cast<float>(curves.getRangeMin()), static_cast<float>(curves.getRangeMax())};
+            ImGui::Text("t       ");
+            ImGui::SameLine();
+            if(ImGui::InputFloat2("##trange", trange))
+            {
+                graph.setParameterRange(trange[0], trange[1]);
+                graph.updateVertices();
+            }
+        }
+
+        if(engine == Sampler::Simd)
+        {
+            static int isa = SimdEvaluator::detectIsa();
+            static const char* isas[] = {"Scalar", "SSE2", "AVX2"};
+            ImGui::Text("ISA     ");
+            ImGui::SameLine();
+            if(ImGui::Combo("##isa", &isa, isas, IM_ARRAYSIZE(isas)))
+            {
+                graph.setSimdIsa(static_cast<SimdEvaluator::Isa>(isa));
+                isa = graph.getSampler().getSimd().getIsa(); // unsupported sets fall back
+                graph.updateVertices();
+            }
+        }
+
+        ImGui::Text("Function");
+        for(int i = 0; i < graph.getFunctionCount(); i++)
         {
-            graph_shader.use();
-            graph_shader.setUniform("color", color_function[0], color_function[1], color_function[2]);
+            glm::vec3 color_function = graph.getColor(i);
+            ImGui::SameLine();
+            ImGui::PushID(i);
+            if(ImGui::ColorEdit3("Function Color", &color_function.x, ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoLabel))
+                graph.setColor(i, color_function);
+            ImGui::PopID();
         }
 
         ImGui::Text("Axis    ");
@@ -396,6 +517,10 @@ int main ()
         {
             shader.use();
             shader.setUniform("color", color_axis[0], color_axis[1], color_axis[2]);
+            tick_shader.use();
+            tick_shader.setUniform("color", color_axis[0], color_axis[1], color_axis[2]);
+            grid_shader.use();
+            grid_shader.setUniform("color", color_axis[0], color_axis[1], color_axis[2]);
         }
 
         ImGui::Text("Glyph   ");
@@ -411,8 +536,10 @@ int main ()
          *
          */
 
+        profiler.begin(FrameProfiler::Interface);
         ImGui::Render();
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        profiler.end(FrameProfiler::Interface);
 
         /*
          *
@@ -420,7 +547,9 @@ int main ()
          *
          */
 
+        profiler.begin(FrameProfiler::DebugText);
         text.render(font_arial, str_fps, 5.0f, 5.0f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 1.0f);
+        profiler.end(FrameProfiler::DebugText);
 
         /*
          *
@@ -439,11 +568,14 @@ int main ()
      */
 
     graph.destroy();
+    profiler.destroy();
 
     shader.destroy();
     glyph_shader.destroy();
     scaled_glyph_shader.destroy();
     graph_shader.destroy();
+    tick_shader.destroy();
+    grid_shader.destroy();
 
     /*
      *
@@ -493,7 +625,7 @@ void scroll_callback (GLFWwindow* window, double xOffset, double yOffset)
 {
     double xpos, ypos;
     glfwGetCursorPos(window, &xpos, &ypos);
-    camera.zoom_on_position(xpos, ypos, yOffset / 10.0f);
+    camera.zoom_on_position(xpos, ypos, camera.getZoom() * yOffset / 10.0f); // by 10% a notch, so deep zooms stay reachable
 }
 
 void key_callback (GLFWwindow *window, int key, int scancode, int action, int mods)
@@ -21,7 +21,7 @@ Object::Object
     GLuint _EBO,
     Container* _container
 )
-    : shader(_shader), camera(_camera)
+    : shader(_shader), camera(_camera), modelUniform(_shader.getUniform("model"))
 {
     if(_container != nullptr)
     {
@@ -52,6 +52,17 @@ void Object::updateModel ()
     model = glm::scale(model, {size.x, size.y, 0.0f});
 }
 
+// The model matrix with the translation taken from the camera's floating origin, in double
+glm::mat4 Object::relativeModel () const
+{
+    const glm::dvec2& origin = camera.getOrigin();
+
+    glm::mat4 relative = model;
+    relative[3][0] = static_cast<float>(position.x - origin.x);
+    relative[3][1] = static_cast<float>(position.y - origin.y);
+    return relative;
+}
+
 void Object::destroy ()
 {
     if(container_allocated)
@@ -74,7 +85,8 @@ void Object::destroy ()
 void Object::drawArrays (GLenum mode, GLsizei count) const
 {
     shader.use();
-    shader.setUniformMatrix4("model", 1, GL_FALSE, glm::value_ptr(model));
+    const glm::mat4 relative = relativeModel();
+    shader.setUniformMatrix4(modelUniform, 1, GL_FALSE, glm::value_ptr(relative));
 
     container->bind_VAO();
     glDrawArrays(mode, 0, count);
@@ -83,7 +95,8 @@ void Object::drawArrays (GLenum mode, GLsizei count) const
 void Object::drawElements (GLenum mode) const
 {
     shader.use();
-    shader.setUniformMatrix4("model", 1, GL_FALSE, glm::value_ptr(model));
+    const glm::mat4 relative = relativeModel();
+    shader.setUniformMatrix4(modelUniform, 1, GL_FALSE, glm::value_ptr(relative));
     
     container->bind_VAO();
     glDrawElements(mode, container->getIndicesCount(), GL_UNSIGNED_INT, 0);
@@ -0,0 +1,103 @@
+#include "include/ringcontainer.hpp"
+#include "include/debug/ClassManager.hpp"
+#include <string>
+#include <vector>
+
+/*
+ *
+ * RingContainer
+ *
+ */
+
+void RingContainer::reset (GLsizei _capacity, int _curves)
+{
+    capacity = _capacity;
+    curves = _curves;
+    first = 0;
+    count = 0;
+
+    new_vertices((capacity + 1) * curves * 2); /* x,y attributes, +1 for the mirror of slot 0 */
+    update_VAO();
+}
+
+void RingContainer::setWindow (long long _first, GLsizei _count)
+{
+    first = _first;
+    count = _count;
+}
+
+void RingContainer::upload (int curve, GLsizei _slot, GLsizei _count)
+{
+    const GLsizei base = getCurveFirst(curve);
+    update_VBO((base + _slot) * 2, _count * 2);
+
+    if(_slot == 0)
+    {
+        GLfloat* const vertices = getVertices() + base * 2;
+        vertices[capacity * 2]     = vertices[0];
+        vertices[capacity * 2 + 1] = vertices[1];
+        update_VBO((base + capacity) * 2, 2);
+    }
+}
+
+void RingContainer::draw (GLenum mode) const
+{
+    if(count == 0 || curves == 0)
+        return;
+
+    std::vector<GLint> firsts;
+    std::vector<GLsizei> counts;
+
+    const GLsizei begin = slot(first);
+    for(int curve = 0; curve < curves; curve++)
+    {
+        const GLint base = getCurveFirst(curve);
+        if(begin + count <= capacity)
+        {
+            firsts.push_back(base + begin);
+            counts.push_back(count);
+        }
+        else
+        {
+            const GLsizei tail = capacity - begin;
+            firsts.push_back(base + begin);
+            counts.push_back(tail + 1); // through the mirror of slot 0
+            firsts.push_back(base);
+            counts.push_back(count - tail);
+        }
+    }
+
+    bind_VAO();
+    glMultiDrawArrays(mode, firsts.data(), counts.data(), static_cast<GLsizei>(firsts.size()));
+}
+
+/*
+ *
+ * ClassManager
+ *
+ */
+
+void ClassManager::ImGui_printClassData (const char* nodelabel, const char* type, const RingContainer* ring)
+{
+    static const ImVec4 color = {1.0f, 0.0f, 1.0f, 1.0f};
+
+    ImGui::PushID(ring);
+
+    if(ImGui_treeNode(nodelabel, type))
+    {
+        std::string str_window   = "[" + std::to_string(ring->getFirst()) + ", " + std::to_string(ring->getFirst() + ring->getCount()) + ")";
+        std::string str_capacity = std::to_string(ring->getCount()) + " [MAX " + std::to_string(ring->getCapacity()) + "]";
+        std::string str_slot     = std::to_string(ring->getCapacity() ? ring->slot(ring->getFirst()) : 0);
+
+        const Container* container = ring;
+        ImGui_printClassData(container);
+
+        ImGui_printLabel(color, "window", str_window.c_str());
+        ImGui_printLabel(color, "samples", str_capacity.c_str());
+        ImGui_printLabel(color, "curves", std::to_string(ring->getCurves()).c_str());
+        ImGui_printLabel(color, "first slot", str_slot.c_str());
+
+        ImGui::TreePop();
+    }
+    ImGui::PopID();
+}
@@ -0,0 +1,399 @@
+#include "include/sampler.hpp"
+#include <algorithm>
+#include <limits>
+
+/*
+ *
+ * Sampler
+ *
+ */
+
+Sampler::Sampler (unsigned int _threadCount)
+{
+    if(_threadCount == 0)
+        _threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for(unsigned int i = 0; i < _threadCount; i++)
+    {
+        Worker* worker = new Worker;
+        worker->X.resize(BULK_SIZE);
+        worker->Y.resize(BULK_SIZE);
+        bindParsers(*worker);
+        workers.emplace_back(worker);
+    }
+    programs.emplace_back(new Program);
+
+    for(unsigned int i = 1; i < _threadCount; i++)
+        threads.emplace_back(&Sampler::workerLoop, this, i);
+}
+
+Sampler::~Sampler ()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    wake.notify_all();
+
+    for(std::thread& thread : threads)
+        thread.join();
+}
+
+/*
+ *
+ * Function
+ *
+ */
+
+void Sampler::setFunction (const char* func)
+{
+    setFunctions({func});
+}
+
+// Throws mu::Parser::exception_type and keeps the previous functions if any new one is invalid
+void Sampler::setFunctions (const std::vector<std::string>& funcs)
+{
+    if(funcs.empty())
+        throw mu::Parser::exception_type("no function");
+
+    mu::Parser parser;
+    double x = 0.0;
+    parser.DefineVar("x", &x);
+    for(const std::string& func : funcs)
+    {
+        parser.SetExpr(func);
+        parser.Eval();
+    }
+
+    functions = funcs;
+    for(std::unique_ptr<Worker>& worker : workers)
+        bindParsers(*worker);
+
+    compile();
+}
+
+void Sampler::testFunction ()
+{
+    for(std::unique_ptr<mu::Parser>& parser : workers[0]->parsers)
+        parser->Eval();
+}
+
+// One parser per function, all bound to the worker's abscissae
+void Sampler::bindParsers (Worker& worker)
+{
+    worker.parsers.resize(functions.size());
+    for(size_t i = 0; i < functions.size(); i++)
+    {
+        if(!worker.parsers[i])
+        {
+            worker.parsers[i].reset(new mu::Parser);
+            worker.parsers[i]->DefineVar("x", worker.X.data());
+        }
+        worker.parsers[i]->SetExpr(functions[i]);
+    }
+}
+
+/*
+ *
+ * Engine
+ *
+ */
+
+void Sampler::setEngine (Engine _engine)
+{
+    engine = _engine;
+    compile();
+}
+
+void Sampler::setSimdIsa (SimdEvaluator::Isa isa)
+{
+    for(std::unique_ptr<Program>& program : programs)
+        program->simd.setIsa(isa);
+}
+
+void Sampler::setDerivative (int order)
+{
+    derivative = std::max(0, std::min(2, order));
+}
+
+Sampler::Engine Sampler::getActiveEngine (int function) const
+{
+    const Program& program = *programs[function];
+    if(engine == Jit && program.jit.isCompiled())
+        return Jit;
+    if(engine == Simd && program.simd.isLoaded())
+        return Simd;
+    return Interpreter;
+}
+
+const char* Sampler::getEngineName (Engine _engine)
+{
+    switch(_engine)
+    {
+    case Jit:  return "JIT";
+    case Simd: return "SIMD";
+    default:  return "Interpreter";
+    }
+}
+
+// Lowers the current functions for the selected engine, the parsers stay the fallback
+void Sampler::compile ()
+{
+    const SimdEvaluator::Isa isa = programs[0]->simd.getIsa();
+    while(programs.size() < functions.size())
+    {
+        programs.emplace_back(new Program);
+        programs.back()->simd.setIsa(isa);
+    }
+    programs.resize(functions.size());
+
+    Worker& worker = *workers[0];
+    for(size_t i = 0; i < functions.size(); i++)
+    {
+        Program& program = *programs[i];
+        program.jit.release();
+        program.simd.clear();
+        program.interval.clear();
+        program.dual.clear();
+        program.bytecode.clear();
+
+        mu::Parser& parser = *worker.parsers[i];
+        parser.Eval(); // makes sure the bytecode exists
+
+        if(!program.bytecode.load(parser, worker.X.data()))
+            continue;
+        program.optimizer.run(program.bytecode);
+        program.interval.load(program.bytecode);
+        program.dual.load(program.bytecode);
+
+        if(engine == Jit)
+            program.jit.compile(program.bytecode);
+        else if(engine == Simd)
+            program.simd.load(program.bytecode);
+    }
+}
+
+/*
+ *
+ * Sampling
+ *
+ */
+
+bool Sampler::enclose (double a, double b, Interval& y, int function) const
+{
+    const IntervalEvaluator& interval = programs[function]->interval;
+    if(!interval.isLoaded() || derivative > 0)
+        return false;
+
+    y = interval.eval({a, b});
+    return true;
+}
+
+void Sampler::sample
+(
+    float* vertices, int count, int stride,
+    double start, double step,
+    double originX, double originY,
+    float ratioX, float ratioY
+)
+{
+    Job current = {};
+    current.vertices = vertices;
+    current.stride = stride;
+    current.count = count;
+    current.start = start;
+    current.step = step;
+    current.originX = originX;
+    current.originY = originY;
+    current.ratioX = ratioX;
+    current.ratioY = ratioY;
+    current.order = derivative;
+    run(current);
+}
+
+void Sampler::evaluate (const double* x, double* y, int count, int function)
+{
+    Job current = {};
+    current.x = x;
+    current.y = y;
+    current.order = derivative;
+    current.function = function;
+    current.count = count;
+    run(current);
+}
+
+bool Sampler::evaluateSlope (const double* x, double* s, int count, int function)
+{
+    if(!programs[function]->dual.isLoaded() || derivative >= 2)
+        return false;
+
+    Job current = {};
+    current.x = x;
+    current.y = s;
+    current.order = derivative + 1;
+    current.function = function;
+    current.count = count;
+    run(current);
+    return true;
+}
+
+// Splits the job into slices, the calling thread takes the first one
+void Sampler::run (Job current)
+{
+    if(current.count <= 0)
+        return;
+
+    for(std::unique_ptr<Program>& program : programs)
+        program->bytecode.prepare(); // x-invariant values, once per pass
+
+    const int slices = std::min(getThreadCount(), (current.count + MIN_SLICE - 1) / MIN_SLICE);
+    current.sliceSize = (current.count + slices - 1) / slices;
+
+    if(slices == 1)
+    {
+        sampleSlice(*workers[0], current, 0);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = current;
+        pending = static_cast<int>(threads.size());
+        error = nullptr;
+        generation++;
+    }
+    wake.notify_all();
+
+    std::exception_ptr callerError;
+    try
+    {
+        sampleSlice(*workers[0], current, 0);
+    }
+    catch (...)
+    {
+        callerError = std::current_exception();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this]{ return pending == 0; });
+
+    if(callerError) std::rethrow_exception(callerError);
+    if(error)       std::rethrow_exception(error);
+}
+
+// y[i] = f(x[i]), or its derivative of the given order, with the worker's own parser,
+// x and y may be the worker's own arrays
+void Sampler::evaluateSlice (Worker& worker, int function, int order, const double* x, double* y, int count)
+{
+    const Program& program = *programs[function];
+
+    if(order > 0)
+    {
+        // no dual form, no derivative
+        if(!program.dual.isLoaded())
+        {
+            std::fill(y, y + count, std::numeric_limits<double>::quiet_NaN());
+            return;
+        }
+
+        for(int i = 0; i < count; i++)
+        {
+            const Dual d = program.dual.eval(x[i]);
+            y[i] = (order == 1) ? d.d1 : d.d2;
+        }
+        return;
+    }
+
+    if(engine == Jit && program.jit.isCompiled())
+    {
+        for(int i = 0; i < count; i++)
+            y[i] = program.jit(x[i]);
+        return;
+    }
+
+    if(engine == Simd && program.simd.isLoaded())
+    {
+        program.simd.eval(x, y, count);
+        return;
+    }
+
+    mu::Parser& parser = *worker.parsers[function];
+    for(int bulk = 0; bulk < count; bulk += BULK_SIZE)
+    {
+        const int size = std::min(BULK_SIZE, count - bulk);
+        if(x != worker.X.data())
+            std::copy(x + bulk, x + bulk + size, worker.X.begin());
+        parser.Eval(worker.Y.data(), size);
+        if(y != worker.Y.data())
+            std::copy(worker.Y.begin(), worker.Y.begin() + size, y + bulk);
+    }
+}
+
+// Evaluates the index-th slice of the job with the worker's own parsers
+void Sampler::sampleSlice (Worker& worker, const Job& _job, int index)
+{
+    const int first = index * _job.sliceSize;
+    const int last  = std::min(_job.count, first + _job.sliceSize);
+
+    if(_job.x != nullptr)
+    {
+        evaluateSlice(worker, _job.function, _job.order, _job.x + first, _job.y + first, last - first);
+        return;
+    }
+
+    // Abscissae are computed once per bulk and shared by every function
+    for(int bulk = first; bulk < last; bulk += BULK_SIZE)
+    {
+        const int count = std::min(BULK_SIZE, last - bulk);
+
+        for(int i = 0; i < count; i++)
+            worker.X[i] = _job.start + (bulk + i) * _job.step;
+
+        for(int function = 0; function < getFunctionCount(); function++)
+        {
+            evaluateSlice(worker, function, _job.order, worker.X.data(), worker.Y.data(), count);
+
+            float* vertices = _job.vertices + (function * _job.stride + bulk) * 2; /* x,y attributes */
+            for(int i = 0; i < count; i++)
+            {
+                *vertices++ = _job.originX + worker.X[i] * _job.ratioX;
+                *vertices++ = _job.originY + worker.Y[i] * _job.ratioY;
+            }
+        }
+    }
+}
+
+void Sampler::workerLoop (int index)
+{
+    Worker& worker = *workers[index];
+    unsigned int seen = 0;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for(;;)
+    {
+        wake.wait(lock, [&]{ return quit || generation != seen; });
+        if(quit)
+            return;
+
+        seen = generation;
+        const Job current = job;
+        lock.unlock();
+
+        std::exception_ptr sliceError;
+        try
+        {
+            if(index * current.sliceSize < current.count)
+                sampleSlice(worker, current, index);
+        }
+        catch (...)
+        {
+            sliceError = std::current_exception();
+        }
+
+        lock.lock();
+        if(sliceError && !error)
+            error = sliceError;
+        if(--pending == 0)
+            done.notify_one();
+    }
+}
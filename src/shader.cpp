@@ -1,6 +1,8 @@
 #include "include/shader.hpp"
 #include "include/debug/ClassManager.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <fstream>
 #include <iostream>
 
@@ -22,6 +24,13 @@ void ClassManager::ImGui_printClassData (const char* nodelabel, const char* type
         ImGui_printLabel(color, "fragment shader", str_fragmentShader.c_str());
         ImGui_printLabel(color, "geometry shader", str_geometryShader.c_str());
 
+        for(const auto& uniform : shader.getUniforms())
+        {
+            std::string str_uniform = "location " + std::to_string(uniform.second.location) +
+                                      ((uniform.second.size > 1) ? " [" + std::to_string(uniform.second.size) + "]" : "");
+            ImGui_printLabel(color, uniform.first.c_str(), str_uniform.c_str());
+        }
+
         ImGui::TreePop();
     }
     ImGui::PopID();
@@ -45,22 +54,49 @@ void ClassManager::ImGui_printClassData (const char* nodelabel, const char* type
 #define SET_UNIFORM_ARGS_3(TYPE) SET_UNIFORM_ARGS_2(TYPE), v2
 #define SET_UNIFORM_ARGS_4(TYPE) SET_UNIFORM_ARGS_3(TYPE), v3
 
-#define SET_UNIFORM(NUM, TYPE_LTR, TYPE)                                                            \
-        void Shader::setUniform (const char* name, SET_UNIFORM_PARAMS_##NUM (TYPE) )                \
-        {                                                                                           \
-            glUniform ##NUM ##TYPE_LTR (getUniformLocation(name), SET_UNIFORM_ARGS_ ## NUM (TYPE)); \
+#define UNIFORM_SCALAR_f  GL_FLOAT
+#define UNIFORM_SCALAR_i  GL_INT
+#define UNIFORM_SCALAR_ui GL_UNSIGNED_INT
+
+// GL ignores a call of the wrong type for the uniform, debug builds stop at it instead
+#ifdef GRAPH_DEBUG
+    #define CHECK_UNIFORM(UNIFORM, ACCEPTED, COUNT) \
+            assert(((UNIFORM).location < 0 || (ACCEPTED)) && (COUNT) <= std::max<GLsizei>((UNIFORM).size, 1))
+#else
+    #define CHECK_UNIFORM(UNIFORM, ACCEPTED, COUNT)
+#endif
+
+#define SET_UNIFORM(NUM, TYPE_LTR, TYPE)                                                                  \
+        void Shader::setUniform (const char* name, SET_UNIFORM_PARAMS_##NUM (TYPE) )                      \
+        {                                                                                                 \
+            setUniform(getUniform(name), SET_UNIFORM_ARGS_ ## NUM (TYPE));                                \
+        }                                                                                                 \
+        void Shader::setUniform (const UniformHandle& uniform, SET_UNIFORM_PARAMS_##NUM (TYPE) )          \
+        {                                                                                                 \
+            CHECK_UNIFORM(uniform, accepts_uniform(uniform.type, UNIFORM_SCALAR_##TYPE_LTR, NUM), 1);     \
+            glUniform ##NUM ##TYPE_LTR (uniform.location, SET_UNIFORM_ARGS_ ## NUM (TYPE));               \
         }
 
-#define SET_UNIFORMV(NUM, TYPE_LTR, TYPE)                                                      \
-        void Shader::setUniform ##NUM ##v (const char* name, GLsizei count, const TYPE *value) \
-        {                                                                                      \
-            glUniform ##NUM ##TYPE_LTR ##v (getUniformLocation(name), count, value);           \
+#define SET_UNIFORMV(NUM, TYPE_LTR, TYPE)                                                                  \
+        void Shader::setUniform ##NUM ##v (const char* name, GLsizei count, const TYPE *value)             \
+        {                                                                                                  \
+            setUniform ##NUM ##v (getUniform(name), count, value);                                         \
+        }                                                                                                  \
+        void Shader::setUniform ##NUM ##v (const UniformHandle& uniform, GLsizei count, const TYPE *value) \
+        {                                                                                                  \
+            CHECK_UNIFORM(uniform, accepts_uniform(uniform.type, UNIFORM_SCALAR_##TYPE_LTR, NUM), count);  \
+            glUniform ##NUM ##TYPE_LTR ##v (uniform.location, count, value);                               \
         }
 
-#define SET_UNIFORM_MATRIX(SUFFIX)                                                                                          \
-        void Shader::setUniformMatrix ##SUFFIX (const char* name, GLsizei count, GLboolean transpose, const GLfloat *value) \
-        {                                                                                                                   \
-            glUniformMatrix ##SUFFIX ##fv (getUniformLocation(name), count, transpose, value);                              \
+#define SET_UNIFORM_MATRIX(SUFFIX)                                                                                                      \
+        void Shader::setUniformMatrix ##SUFFIX (const char* name, GLsizei count, GLboolean transpose, const GLfloat *value)             \
+        {                                                                                                                               \
+            setUniformMatrix ##SUFFIX (getUniform(name), count, transpose, value);                                                      \
+        }                                                                                                                               \
+        void Shader::setUniformMatrix ##SUFFIX (const UniformHandle& uniform, GLsizei count, GLboolean transpose, const GLfloat *value) \
+        {                                                                                                                               \
+            CHECK_UNIFORM(uniform, uniform.type == GL_FLOAT_MAT ##SUFFIX, count);                                                       \
+            glUniformMatrix ##SUFFIX ##fv (uniform.location, count, transpose, value);                                                  \
         }
 
 #define SET_UNIFORMS(TYPE_LTR, TYPE)        \
@@ -83,6 +119,40 @@ void ClassManager::ImGui_printClassData (const char* nodelabel, const char* type
  *
  */
 
+#ifdef GRAPH_DEBUG
+// Whether glUniform{components}{f|i|ui} can set a uniform of the GL type, booleans take all three
+static bool accepts_uniform (GLenum type, GLenum scalar, int components)
+{
+    static const struct { GLenum type; GLenum scalar; int components; } vectors[] =
+    {
+        {GL_FLOAT,        GL_FLOAT,        1}, {GL_FLOAT_VEC2,        GL_FLOAT,        2}, {GL_FLOAT_VEC3,        GL_FLOAT,        3}, {GL_FLOAT_VEC4,        GL_FLOAT,        4},
+        {GL_INT,          GL_INT,          1}, {GL_INT_VEC2,          GL_INT,          2}, {GL_INT_VEC3,          GL_INT,          3}, {GL_INT_VEC4,          GL_INT,          4},
+        {GL_UNSIGNED_INT, GL_UNSIGNED_INT, 1}, {GL_UNSIGNED_INT_VEC2, GL_UNSIGNED_INT, 2}, {GL_UNSIGNED_INT_VEC3, GL_UNSIGNED_INT, 3}, {GL_UNSIGNED_INT_VEC4, GL_UNSIGNED_INT, 4},
+        {GL_BOOL,         GL_BOOL,         1}, {GL_BOOL_VEC2,         GL_BOOL,         2}, {GL_BOOL_VEC3,         GL_BOOL,         3}, {GL_BOOL_VEC4,         GL_BOOL,         4},
+    };
+    static const GLenum matrices[] =
+    {
+        GL_FLOAT_MAT2,   GL_FLOAT_MAT3,   GL_FLOAT_MAT4,
+        GL_FLOAT_MAT2x3, GL_FLOAT_MAT3x2, GL_FLOAT_MAT2x4,
+        GL_FLOAT_MAT4x2, GL_FLOAT_MAT3x4, GL_FLOAT_MAT4x3
+    };
+
+    for(const auto& vector : vectors)
+    {
+        if(vector.type == type)
+            return vector.components == components && (vector.scalar == scalar || vector.scalar == GL_BOOL);
+    }
+    for(GLenum matrix : matrices)
+    {
+        if(matrix == type)
+            return false;
+    }
+
+    // samplers and images take the texture unit
+    return scalar == GL_INT && components == 1;
+}
+#endif
+
 static GLuint create_shader
 (
     GLenum             shaderType,
@@ -117,14 +187,43 @@ static GLuint create_shader
  *
  */
 
-GLint Shader::getUniformLocation (const char* name)
+const UniformHandle& Shader::getUniform (const std::string& name) const
+{
+    static const UniformHandle inactive;
+
+    auto uniform = uniforms.find(name);
+    if(uniform == uniforms.end())
+        return inactive;
+    return uniform->second;
+}
+
+// Every active uniform of the linked program, so that no location is looked up while drawing
+void Shader::reflectUniforms ()
 {
-    auto uniformLocation = uniformLocations.find(name);
-    if(uniformLocation == uniformLocations.end())
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(m_ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string name(maxLength, '\0');
+    for(GLint i = 0; i < count; i++)
     {
-        return (uniformLocations[name] = glGetUniformLocation(m_ID, name));
+        UniformHandle uniform;
+        GLsizei length = 0;
+        glGetActiveUniform(m_ID, i, maxLength, &length, &uniform.size, &uniform.type, &name[0]);
+
+        // block members have no location
+        std::string uniformName = name.substr(0, length);
+        uniform.location = glGetUniformLocation(m_ID, uniformName.c_str());
+        if(uniform.location < 0)
+            continue;
+
+        // arrays are reported as "name[0]"
+        if(uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            uniformName.resize(uniformName.size() - 3);
+
+        uniforms[uniformName] = uniform;
     }
-    return uniformLocation->second;
 }
 
 Shader::Shader(const std::string& _vertexPath,
@@ -161,16 +260,20 @@ Shader::Shader(const std::string& _vertexPath,
 
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+
+    if(success)
+        reflectUniforms();
 }
 
 void Shader::destroy () const
 {
+    GLState::releaseProgram(m_ID);
     glDeleteProgram(m_ID);
 }
 
 void Shader::use () const
 {
-    glUseProgram(m_ID);
+    GLState::useProgram(m_ID);
 }
 
 SET_UNIFORMS(f, GLfloat)
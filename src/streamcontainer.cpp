@@ -0,0 +1,158 @@
+#include "include/streamcontainer.hpp"
+#include "include/debug/ClassManager.hpp"
+#include <string>
+
+/*
+ *
+ * StreamContainer
+ *
+ */
+
+void StreamContainer::create ()
+{
+    persistent = GLAD_GL_VERSION_4_4 != 0;
+    glGenVertexArrays(REGIONS, VAOs);
+    allocate(1024);
+}
+
+void StreamContainer::destroy ()
+{
+    for(int r = 0; r < REGIONS; r++)
+    {
+        GLState::releaseVertexArray(VAOs[r]);
+        if(fences[r])
+            glDeleteSync(fences[r]);
+        fences[r] = 0;
+    }
+    glDeleteVertexArrays(REGIONS, VAOs);
+
+    GLState::releaseBuffer(VBO);
+    glDeleteBuffers(1, &VBO); // unmaps it
+    mapped = nullptr;
+}
+
+// Immutable storage cannot grow, the buffer is replaced, GL keeps the old one alive while it is drawn
+void StreamContainer::allocate (GLsizei _capacity)
+{
+    if(VBO)
+    {
+        GLState::releaseBuffer(VBO);
+        glDeleteBuffers(1, &VBO);
+    }
+    for(GLsync& fence : fences)
+    {
+        if(fence)
+            glDeleteSync(fence);
+        fence = 0;
+    }
+
+    capacity = _capacity;
+    const GLsizeiptr size = static_cast<GLsizeiptr>(capacity) * REGIONS * sizeof(GLfloat);
+
+    glGenBuffers(1, &VBO);
+    GLState::bindArrayBuffer(VBO);
+    if(persistent)
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+        mapped = static_cast<GLfloat*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags));
+    }
+    else
+    {
+        glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+        staging.resize(capacity);
+    }
+
+    // one VAO per region, so that the vertices of every region start at 0
+    for(int r = 0; r < REGIONS; r++)
+    {
+        GLState::bindVertexArray(VAOs[r]);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), (void*)(static_cast<GLsizeiptr>(capacity) * r * sizeof(GLfloat)));
+        glEnableVertexAttribArray(0);
+    }
+
+    count = 0; // the vertices drawn so far are gone with the old buffer
+}
+
+void StreamContainer::wait (int _region)
+{
+    GLsync& fence = fences[_region];
+    if(!fence)
+        return;
+
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if(status == GL_TIMEOUT_EXPIRED)
+    {
+        waits++;
+        do
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+        while(status == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    fence = 0;
+}
+
+GLfloat* StreamContainer::map (GLsizei _count)
+{
+    if(_count > capacity)
+        allocate(_count + _count / 2);
+
+    const int next = (region + 1) % REGIONS;
+    wait(next);
+
+    mappedCount = _count;
+    return persistent ? mapped + static_cast<size_t>(capacity) * next : staging.data();
+}
+
+void StreamContainer::commit ()
+{
+    const int next = (region + 1) % REGIONS;
+    if(!persistent)
+    {
+        GLState::bindArrayBuffer(VBO);
+        glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(capacity) * next * sizeof(GLfloat), mappedCount * sizeof(GLfloat), staging.data());
+    }
+
+    region = next;
+    count = mappedCount;
+}
+
+void StreamContainer::bind_VAO () const
+{
+    GLState::bindVertexArray(VAOs[region]);
+}
+
+void StreamContainer::fence ()
+{
+    if(fences[region])
+        glDeleteSync(fences[region]);
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+/*
+ *
+ * ClassManager
+ *
+ */
+
+void ClassManager::ImGui_printClassData (const char* nodelabel, const char* type, const StreamContainer* stream)
+{
+    static const ImVec4 color = {1.0f, 0.0f, 1.0f, 1.0f};
+
+    ImGui::PushID(stream);
+
+    if(ImGui_treeNode(nodelabel, type))
+    {
+        std::string str_vertices = std::to_string(stream->getCount()) + " [MAX " + std::to_string(stream->getCapacity()) + "]";
+        std::string str_region   = std::to_string(stream->getRegion()) + " of " + std::to_string(StreamContainer::REGIONS);
+
+        ImGui_printLabel(color, "mode", stream->isPersistent() ? "persistent mapping" : "staging");
+        ImGui_printLabel(color, "vertices", str_vertices.c_str());
+        ImGui_printLabel(color, "region", str_region.c_str());
+        ImGui_printLabel(color, "waits", std::to_string(stream->getWaits()).c_str());
+
+        ImGui::TreePop();
+    }
+    ImGui::PopID();
+}
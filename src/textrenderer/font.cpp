@@ -1,7 +1,15 @@
 #include "../include/textrenderer/font.hpp"
 #include <iostream>
+#include <cstring>
+#include <algorithm>
+#include FT_MODULE_H
 
-Font::Font (const FT_Library& ft, const std::string& fontpath)
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+
+Font::Font (const FT_Library& ft, const std::string& fontpath, Rendering _rendering)
+    : rendering(_rendering)
 {
     FT_Face face;
     if(FT_New_Face(ft, fontpath.c_str(), 0, &face))
@@ -11,13 +19,30 @@ Font::Font (const FT_Library& ft, const std::string& fontpath)
         return;
     }
 
-    FT_Set_Pixel_Sizes(face, 0, 48);
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+    if(rendering == Sdf)
+    {
+        // a small SDF scales to any size, its metrics are brought to those of the Bitmap glyphs
+        const FT_Int spread = SDF_SPREAD;
+        FT_Property_Set(ft, "sdf", "spread", &spread);
+        FT_Set_Pixel_Sizes(face, 0, SDF_PIXEL_SIZE);
+        metricScale = static_cast<float>(FONT_PIXEL_SIZE) / SDF_PIXEL_SIZE;
+        margin = SDF_SPREAD;
+    }
+    else
+    {
+        FT_Set_Pixel_Sizes(face, 0, FONT_PIXEL_SIZE);
+    }
+
+    // the bitmaps are kept until the atlas is packed
+    std::vector<std::vector<unsigned char>> bitmaps(MAX_CHAR - MIN_CHAR);
+    stbrp_rect rects[MAX_CHAR - MIN_CHAR];
 
     for(unsigned char c = MIN_CHAR; c < MAX_CHAR; c++)
     {
-        // load character glyph
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER))
+        // load character glyph, the SDF ones are rendered from the outline ("space" has none)
+        const bool sdf = rendering == Sdf;
+        if (FT_Load_Char(face, c, sdf ? FT_LOAD_DEFAULT : FT_LOAD_RENDER) ||
+            (sdf && face->glyph->outline.n_points > 0 && FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF)))
         {
             std::cout << "Error: Failed to load Glyph '" << c << "' for font \"" << fontpath << '"' << std::endl;
             anyerr = true;
@@ -27,36 +52,26 @@ Font::Font (const FT_Library& ft, const std::string& fontpath)
         if(anyerr)
             continue;
 
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D
-        (
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // store character for later use
-        Character &ch = characters[c - MIN_CHAR] =
+        const FT_Bitmap& bitmap = face->glyph->bitmap;
+        std::vector<unsigned char>& pixels = bitmaps[c - MIN_CHAR];
+        pixels.resize(bitmap.width * bitmap.rows);
+        for(unsigned int row = 0; row < bitmap.rows; row++)
+            std::memcpy(pixels.data() + row * bitmap.width, bitmap.buffer + row * bitmap.pitch, bitmap.width);
+
+        stbrp_rect& rect = rects[c - MIN_CHAR];
+        rect = {};
+        rect.id = c - MIN_CHAR;
+        rect.w  = static_cast<stbrp_coord>(bitmap.width + ATLAS_PADDING);
+        rect.h  = static_cast<stbrp_coord>(bitmap.rows + ATLAS_PADDING);
+
+        // store character for later use, the atlas coordinates are known once it is packed
+        characters[c - MIN_CHAR] =
         {
-            texture,
+            {0.0f, 0.0f},
+            {0.0f, 0.0f},
             glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
             glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            face->glyph->advance.x
+            static_cast<unsigned int>(face->glyph->advance.x)
         };
     }
 
@@ -65,18 +80,49 @@ Font::Font (const FT_Library& ft, const std::string& fontpath)
     if(anyerr)
         return;
 
+    // pack every glyph into one texture, doubling its height until they fit
+    atlasSize = {ATLAS_WIDTH, 64};
+    std::vector<stbrp_node> nodes(ATLAS_WIDTH);
+    for(;;)
+    {
+        stbrp_context context;
+        stbrp_init_target(&context, atlasSize.x, atlasSize.y, nodes.data(), static_cast<int>(nodes.size()));
+        if(stbrp_pack_rects(&context, rects, MAX_CHAR - MIN_CHAR))
+            break;
+        atlasSize.y *= 2;
+    }
+
+    std::vector<unsigned char> pixels(atlasSize.x * atlasSize.y, 0);
+    for(int i = 0; i < MAX_CHAR - MIN_CHAR; i++)
+    {
+        Character& ch = characters[i];
+        const stbrp_rect& rect = rects[i];
+        for(int row = 0; row < ch.size.y; row++)
+            std::memcpy(pixels.data() + (rect.y + row) * atlasSize.x + rect.x, bitmaps[i].data() + row * ch.size.x, ch.size.x);
+
+        ch.uvMin = glm::vec2(rect.x, rect.y) / glm::vec2(atlasSize);
+        ch.uvMax = glm::vec2(rect.x + ch.size.x, rect.y + ch.size.y) / glm::vec2(atlasSize);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+
+    glGenTextures(1, &atlas);
+    GLState::bindTexture2D(0, atlas);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, atlasSize.x, atlasSize.y, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+
+    // set texture options
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
-    glBindVertexArray(VAO);
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+    GLState::bindVertexArray(VAO);
+    GLState::bindArrayBuffer(VBO);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
 }
 
 glm::vec2 Font::calcTextSize (const std::string& text, float scaleX, float scaleY) const
@@ -89,9 +135,10 @@ glm::vec2 Font::calcTextSize (const std::string& text, float scaleX, float scale
     {
         Character ch = characters[*c - MIN_CHAR];
 
-        width += ch.size.x * scaleX;
+        // the margin of a glyph is not part of its outline
+        width += std::max(ch.size.x - 2 * margin, 0) * metricScale * scaleX;
 
-        float newHeight = ch.size.y * scaleY;
+        float newHeight = std::max(ch.size.y - 2 * margin, 0) * metricScale * scaleY;
         if(newHeight > height)
             height = newHeight;
     }
@@ -99,16 +146,21 @@ glm::vec2 Font::calcTextSize (const std::string& text, float scaleX, float scale
     return {width, height};
 }
 
-void Font::render (const std::string& text, float x, float y, float scaleX, float scaleY) const
+void Font::add (const std::string& text, float x, float y, float scaleX, float scaleY)
+{
+    layout(batch, text, x, y, scaleX, scaleY);
+}
+
+void Font::layout (std::vector<GLfloat>& vertices, const std::string& text, float x, float y, float scaleX, float scaleY) const
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(VAO);
+    scaleX *= metricScale;
+    scaleY *= metricScale;
 
     // iterate through all characters
     std::string::const_iterator c;
     for(c = text.begin(); c != text.end(); c++)
     {
-        Character ch = characters[*c - MIN_CHAR];
+        const Character& ch = characters[*c - MIN_CHAR];
 
         float xpos = x + ch.bearing.x * scaleX;
         float ypos = y - (ch.size.y - ch.bearing.y) * scaleY;
@@ -116,32 +168,45 @@ void Font::render (const std::string& text, float x, float y, float scaleX, floa
         float w = ch.size.x * scaleX;
         float h = ch.size.y * scaleY;
 
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
+        const float quad[6][4] = {
+            { xpos,     ypos + h,   ch.uvMin.x, ch.uvMin.y },
+            { xpos,     ypos,       ch.uvMin.x, ch.uvMax.y },
+            { xpos + w, ypos,       ch.uvMax.x, ch.uvMax.y },
 
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }
+            { xpos,     ypos + h,   ch.uvMin.x, ch.uvMin.y },
+            { xpos + w, ypos,       ch.uvMax.x, ch.uvMax.y },
+            { xpos + w, ypos + h,   ch.uvMax.x, ch.uvMin.y }
         };
-
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.texID);
-
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); // be sure to use glBufferSubData and not glBufferData
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        vertices.insert(vertices.end(), &quad[0][0], &quad[0][0] + 6 * 4);
 
         // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
         x += (ch.advance >> 6) * scaleX; // bitshift by 6 to get value in pixels (2^6 = 64 (divide amount of 1/64th pixels by 64 to get amount of pixels))
     }
+}
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+void Font::flush ()
+{
+    if(batch.empty())
+        return;
+
+    const GLsizei count = static_cast<GLsizei>(batch.size());
+
+    GLState::bindArrayBuffer(VBO);
+    if(count > VBOsize)
+        VBOsize = count;
+    glBufferData(GL_ARRAY_BUFFER, VBOsize * sizeof(GLfloat), NULL, GL_STREAM_DRAW); // orphaned, the last frame may still read it
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(GLfloat), batch.data());
+
+    GLState::bindTexture2D(0, atlas);
+    GLState::bindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, count / 4);
+
+    batch.clear();
+}
+
+void Font::draw (const Container& mesh) const
+{
+    GLState::bindTexture2D(0, atlas);
+    mesh.bind_VAO();
+    glDrawArrays(GL_TRIANGLES, 0, mesh.getVerticesCount() / 4);
 }
@@ -2,7 +2,7 @@
 #include <iostream>
 
 TextRenderer::TextRenderer (Shader& _shader)
-    : shader(_shader)
+    : shader(_shader), textColor(_shader.getUniform("textColor"))
 {
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -19,9 +19,9 @@ void TextRenderer::done ()
     FT_Done_FreeType(ft);
 }
 
-GLuint TextRenderer::loadFont (const std::string &fontpath)
+GLuint TextRenderer::loadFont (const std::string &fontpath, Font::Rendering rendering)
 {
-    fonts.push_back({ft, fontpath});
+    fonts.push_back({ft, fontpath, rendering});
     return fontID++;
 }
 
@@ -32,11 +32,34 @@ void TextRenderer::render
     float x, float y,
     float scaleX, float scaleY,
     float colorR, float colorG, float colorB, float alpha
-) const
+)
+{
+    add(_fontID, text, x, y, scaleX, scaleY);
+    flush(_fontID, colorR, colorG, colorB, alpha);
+}
+
+void TextRenderer::add (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY)
+{
+    fonts[_fontID].add(text, x, y, scaleX, scaleY);
+}
+
+void TextRenderer::flush (GLuint _fontID, float colorR, float colorG, float colorB, float alpha)
+{
+    shader.use();
+    shader.setUniform(textColor, colorR, colorG, colorB, alpha);
+    fonts[_fontID].flush();
+}
+
+void TextRenderer::layout (GLuint _fontID, const std::string& text, float x, float y, float scaleX, float scaleY, std::vector<GLfloat>& vertices) const
+{
+    fonts[_fontID].layout(vertices, text, x, y, scaleX, scaleY);
+}
+
+void TextRenderer::render (GLuint _fontID, const Container& mesh, float colorR, float colorG, float colorB, float alpha) const
 {
     shader.use();
-    shader.setUniform("textColor", colorR, colorG, colorB, alpha);
-    fonts[_fontID].render(text, x, y, scaleX, scaleY);
+    shader.setUniform(textColor, colorR, colorG, colorB, alpha);
+    fonts[_fontID].draw(mesh);
 }
 
 glm::vec2 TextRenderer::fontTextSize (GLuint _fontID, const std::string& text, float scaleX, float scaleY) const
@@ -0,0 +1,108 @@
+#include "include/tilecache.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+
+/*
+ *
+ * Helper Functions
+ *
+ */
+
+// Floor division, tiles to the left of x = 0 have negative indices
+static long long tile_of (long long sample)
+{
+    return (sample >= 0) ? sample / TileCache::TILE_SIZE
+                         : -((-sample + TileCache::TILE_SIZE - 1) / TileCache::TILE_SIZE);
+}
+
+/*
+ *
+ * TileCache
+ *
+ */
+
+TileCache::TileCache (std::size_t _budget)
+    : budget(_budget)
+{
+}
+
+void TileCache::setBudget (std::size_t _budget)
+{
+    budget = _budget;
+    evict();
+}
+
+void TileCache::clear ()
+{
+    tiles.clear();
+    index.clear();
+}
+
+void TileCache::fetch (Sampler& sampler, int curve, int level, long long first, int count, double* y)
+{
+    if(count <= 0)
+        return;
+
+    // f, f' and f'' of an expression are told apart by the derivative order
+    std::size_t function = std::hash<std::string>()(sampler.getFunction(curve));
+    function ^= std::hash<int>()(sampler.getDerivative()) + 0x9e3779b97f4a7c15ull + (function << 6) + (function >> 2);
+    const long long firstTile = tile_of(first);
+    const long long lastTile  = tile_of(first + count - 1);
+
+    // evaluate all the missing tiles in one batch
+    std::vector<long long> missing;
+    for(long long t = firstTile; t <= lastTile; t++)
+    {
+        if(index.count({function, level, t}) == 0)
+            missing.push_back(t);
+    }
+
+    if(!missing.empty())
+    {
+        missX.resize(missing.size() * TILE_SIZE);
+        missY.resize(missing.size() * TILE_SIZE);
+        for(size_t m = 0; m < missing.size(); m++)
+            for(int i = 0; i < TILE_SIZE; i++)
+                missX[m * TILE_SIZE + i] = std::ldexp(static_cast<double>(missing[m] * TILE_SIZE + i), level);
+
+        sampler.evaluate(missX.data(), missY.data(), static_cast<int>(missX.size()), curve);
+
+        for(size_t m = 0; m < missing.size(); m++)
+        {
+            const Key key = {function, level, missing[m]};
+            tiles.push_front({key, std::vector<double>(missY.begin() + m * TILE_SIZE, missY.begin() + (m + 1) * TILE_SIZE)});
+            index[key] = tiles.begin();
+        }
+        misses += static_cast<long long>(missing.size());
+    }
+    hits += (lastTile - firstTile + 1) - static_cast<long long>(missing.size());
+
+    // copy the requested samples out, marking the tiles as recently used
+    for(long long t = firstTile; t <= lastTile; t++)
+    {
+        auto tile = index.find({function, level, t});
+        tiles.splice(tiles.begin(), tiles, tile->second);
+
+        const long long tileFirst = t * TILE_SIZE;
+        const long long begin = std::max(first, tileFirst);
+        const long long end   = std::min(first + count, tileFirst + TILE_SIZE);
+
+        const std::vector<double>& values = tile->second->values;
+        std::copy(values.begin() + (begin - tileFirst), values.begin() + (end - tileFirst), y + (begin - first));
+    }
+
+    evict();
+}
+
+// Drops the least recently used tiles until the cache fits its budget.
+// The tiles of the last fetch() are the most recent, so they survive unless they alone exceed it
+void TileCache::evict ()
+{
+    while(!tiles.empty() && getMemory() > budget)
+    {
+        index.erase(tiles.back().key);
+        tiles.pop_back();
+    }
+}